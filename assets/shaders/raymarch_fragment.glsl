@@ -1,23 +1,44 @@
 #version 330 core
-out vec4 FragColor;
+layout(location = 0) out vec4 FragColor;
+// Первое попадание луча: расстояние и объект (для прохода увеличения)
+layout(location = 1) out vec2 SceneData;
+
+// Константы варианта шейдера. ShaderPermutations задаёт их через #define
+// перед компиляцией; здесь - значения для высокого качества
+#ifndef MAX_BOUNCES
+#define MAX_BOUNCES 4  // Глубина рекурсии
+#endif
+#ifndef MAX_STEP_COUNT
+// Макс. кол-во шагов маршинга (точность поиска поверхности)
+#define MAX_STEP_COUNT 160
+#endif
+#ifndef SHADOW_STEPS
+#define SHADOW_STEPS 32  // Шаги луча тени
+#endif
+#ifndef SOFT_SHADOWS
+#define SOFT_SHADOWS 1  // Мягкие тени (0 - жёсткие)
+#endif
+#ifndef MATERIAL_TEXTURES
+#define MATERIAL_TEXTURES 1  // Текстуры материалов
+#endif
+#ifndef REFRACTION
+#define REFRACTION 1  // Преломление в прозрачных объектах
+#endif
+// Число статических коробок известно при загрузке сцены; без него цикл
+// берёт значение из UBO
+#ifndef STATIC_COUNT
+#define STATIC_COUNT staticCount
+#endif
 
-// Константы рендеринга
-const int MAX_BOUNCES = 4;  // Глубина рекурсии
-const int MAX_STEP_COUNT =
-    160;  // Макс. кол-во шагов маршинга (точность поиска поверхности)
 const float MAX_TRACE_DIST = 150.0;  // Дальность прорисовки
 const float HIT_THRESHOLD = 0.001;   // Порог столкновения
 const float SURFACE_BIAS = 0.02;  // Смещение луча от поверхности (чтобы не было
                                   // "дырок" и самопересечений)
 
-// Параметры стола
-const float TABLE_WIDTH = 15.0;
-const float TABLE_HEIGHT = 20.0;
-const float TABLE_Z_POS = -1.0;
-
-// Параметры бортов
-const float BORDER_THICKNESS = 0.5;  // Полу-толщина борта
-const float BORDER_HEIGHT = 1.5;     // Полу-высота борта
+// Во что попал луч
+const int HIT_NONE = 0;    // Ничего (или только оценка сетки)
+const int HIT_STATIC = 1;  // Неподвижная коробка
+const int HIT_OBJECT = 2;  // Подвижный объект
 
 // Uniforms (Камера, Свет, Материалы)
 uniform vec3 cameraPos, cameraView, cameraUp, cameraRight;
@@ -29,9 +50,42 @@ uniform float pointLightBrightness;
 uniform vec3 globalLightDir, globalLightColor;
 uniform float globalLightBrightness;
 
-uniform sampler2D ballTextures[16];
+// Текстуры материалов - слои одного массива с мип-уровнями
+uniform sampler2DArray materialTextures;
+
+// Подвижные объекты (шары и коробки) лежат в texture buffer:
+// 5 текселей RGBA32F на объект, материал задан индексом
+uniform samplerBuffer objectData;
+
+// Таблица материалов сцены: 2 текселя на материал
+uniform samplerBuffer materialData;
+
+const int OBJECT_TEXELS = 5;
+const int MATERIAL_TEXELS = 2;
+const int OBJECT_SPHERE = 0;
+const int OBJECT_BOX = 1;
+
+// Неподвижные коробки (стол, борта) в том же формате, загружаются один
+// раз на сцену
+uniform samplerBuffer staticData;
+
+// Равномерная сетка объектов по плоскости стола: для ячейки хранится
+// (начало, количество) в списке индексов объектов
+uniform isampler2D gridCells;
+uniform isamplerBuffer gridIndices;
 
 // UBO BLOCK (std140)
+layout(std140) uniform ObjectBlock {
+  int objectCount;    // Количество объектов в этом кадре
+  int objectBase;     // Первый тексель объектов этого кадра
+  int gridIndexBase;  // Первый тексель индексов сетки этого кадра
+  int staticCount;    // Количество неподвижных коробок
+  vec2 gridMin;       // Угол сетки
+  float gridCellSize;
+  float gridMargin;  // Объекты внесены в ячейки с этим запасом
+  ivec2 gridSize;    // Число ячеек (0 - сетки нет)
+};
+
 struct BallMaterial {
   vec3 baseColor;
   float roughness;
@@ -41,17 +95,56 @@ struct BallMaterial {
   int textureID;
 };
 
-struct BallData {
-  vec3 position;
-  mat3 rotation;
-  BallMaterial material;
-};
+vec4 objectTexel(int index, int texel) {
+  return texelFetch(objectData, objectBase + index * OBJECT_TEXELS + texel);
+}
 
-layout(std140) uniform BallBlock {
-  float ballRadius;
-  int ballCount;
-  BallData balls[16];
-};
+vec4 staticTexel(int index, int texel) {
+  return texelFetch(staticData, index * OBJECT_TEXELS + texel);
+}
+
+vec3 objectPosition(int index) {
+  return objectTexel(index, 0).xyz;
+}
+
+mat3 objectRotation(int index) {
+  return mat3(objectTexel(index, 2).xyz, objectTexel(index, 3).xyz,
+              objectTexel(index, 4).xyz);
+}
+
+mat3 staticRotation(int index) {
+  return mat3(staticTexel(index, 2).xyz, staticTexel(index, 3).xyz,
+              staticTexel(index, 4).xyz);
+}
+
+vec4 materialTexel(int material, int texel) {
+  return texelFetch(materialData, material * MATERIAL_TEXELS + texel);
+}
+
+float objectTransmission(int index) {
+  return materialTexel(int(objectTexel(index, 1).w), 1).y;
+}
+
+BallMaterial decodeMaterial(int material) {
+  vec4 t0 = materialTexel(material, 0);
+  vec4 t1 = materialTexel(material, 1);
+  BallMaterial mat;
+  mat.baseColor = t0.rgb;
+  mat.roughness = t0.a;
+  mat.metallic = t1.x;
+  mat.transmission = t1.y;
+  mat.refraction = t1.z;
+  mat.textureID = floatBitsToInt(t1.w);
+  return mat;
+}
+
+BallMaterial objectMaterial(int index) {
+  return decodeMaterial(int(objectTexel(index, 1).w));
+}
+
+BallMaterial staticMaterial(int index) {
+  return decodeMaterial(int(staticTexel(index, 1).w));
+}
 
 // SDF функции
 float sdSphere(vec3 p, vec3 center, float radius) {
@@ -63,56 +156,109 @@ float sdBox(vec3 p, vec3 center, vec3 size) {
   return length(max(q, 0.0)) + min(max(q.x, max(q.y, q.z)), 0.0);
 }
 
+// Нормаль повёрнутой коробки: снаружи - направление от ближайшей точки
+// поверхности, внутри - ось ближайшей грани
+vec3 boxNormal(vec3 p, vec3 center, mat3 rotation, vec3 size) {
+  vec3 q = (p - center) * rotation;
+  vec3 d = abs(q) - size;
+  vec3 n;
+  if (any(greaterThan(d, vec3(0.0)))) {
+    n = max(d, 0.0) * sign(q);
+  } else if (d.x > d.y && d.x > d.z) {
+    n = vec3(sign(q.x), 0.0, 0.0);
+  } else if (d.y > d.z) {
+    n = vec3(0.0, sign(q.y), 0.0);
+  } else {
+    n = vec3(0.0, 0.0, sign(q.z));
+  }
+  return normalize(rotation * n);
+}
+
+// Находит ячейку сетки, содержащую точку. Возвращает нижнюю оценку
+// расстояния до объектов, которых нет в списке ячейки: объекты внесены в
+// ячейки с запасом gridMargin, поэтому до остальных не ближе, чем до
+// границы ячейки плюс запас. Без сетки (gridSize.x == 0) список - все
+// объекты кадра подряд, начиная с нулевого
+float gridLookup(vec3 p, out int first, out int count) {
+  first = 0;
+  count = 0;
+  if (gridSize.x == 0) {
+    count = objectCount;
+    return 1e10;
+  }
+
+  vec2 gridMax = gridMin + vec2(gridSize) * gridCellSize;
+  vec2 q = p.xy;
+  if (any(lessThan(q, gridMin)) || any(greaterThanEqual(q, gridMax))) {
+    // Снаружи сетки: все объекты отстоят от её края не меньше чем на запас
+    vec2 outside = max(max(gridMin - q, q - gridMax), 0.0);
+    return length(outside) + gridMargin;
+  }
+
+  ivec2 cell = min(ivec2((q - gridMin) / gridCellSize), gridSize - 1);
+  ivec2 range = texelFetch(gridCells, cell, 0).xy;
+  first = gridIndexBase + range.x;
+  count = range.y;
+
+  vec2 lo = gridMin + vec2(cell) * gridCellSize;
+  vec2 hi = lo + gridCellSize;
+  vec2 toEdge = min(q - lo, hi - q);
+  return max(min(toEdge.x, toEdge.y), 0.0) + gridMargin;
+}
+
 // Сцена
 float sceneSDF(vec3 p,
                out int hitType,
                out int ballIndex,
                bool ignoreTransparent) {
-  hitType = 0;
+  hitType = HIT_NONE;
   ballIndex = -1;
   float min_dist = 1e10;  // Изначально расстояние "бесконечное"
 
-  // Стол
-  float table = sdBox(p, vec3(0.0, 0.0, TABLE_Z_POS),
-                      vec3(TABLE_WIDTH, TABLE_HEIGHT, 1.0));
-  if (table < min_dist) {
-    min_dist = table;
-    hitType = 1;
+  // Неподвижные коробки: стол, борта и прочая статическая геометрия
+  for (int i = 0; i < STATIC_COUNT; ++i) {
+    vec3 local = (p - staticTexel(i, 0).xyz) * staticRotation(i);
+    float dist = sdBox(local, vec3(0.0), staticTexel(i, 1).xyz);
+    if (dist < min_dist) {
+      min_dist = dist;
+      hitType = HIT_STATIC;
+      ballIndex = i;
+    }
   }
 
-  // Борта
-  float borders = 1e10;
-  vec3 vBorderSideSize =
-      vec3(BORDER_THICKNESS, TABLE_HEIGHT + BORDER_THICKNESS, BORDER_HEIGHT);
-  borders =
-      min(borders, sdBox(p, vec3(-TABLE_WIDTH, 0.0, 0.5), vBorderSideSize));
-  borders =
-      min(borders, sdBox(p, vec3(TABLE_WIDTH, 0.0, 0.5), vBorderSideSize));
-
-  vec3 vBorderTopSize =
-      vec3(TABLE_WIDTH + BORDER_THICKNESS, BORDER_THICKNESS, BORDER_HEIGHT);
-  borders =
-      min(borders, sdBox(p, vec3(0.0, -TABLE_HEIGHT, 0.5), vBorderTopSize));
-  borders =
-      min(borders, sdBox(p, vec3(0.0, TABLE_HEIGHT, 0.5), vBorderTopSize));
-
-  if (borders < min_dist) {
-    min_dist = borders;
-    hitType = 2;
+  // Подвижные объекты: проверяем только объекты ячейки сетки. Если оценка
+  // для остальных объектов ближе всего, это не попадание (HIT_NONE), а
+  // лишь ограничение шага
+  int first, count;
+  float bound = gridLookup(p, first, count);
+  if (bound < min_dist) {
+    min_dist = bound;
+    hitType = HIT_NONE;
+    ballIndex = -1;
   }
 
-  // Шары
-  for (int i = 0; i < ballCount; ++i) {
-    // Если это расчет тени, мы игнорируем прозрачные шары, чтобы свет проходил
-    // сквозь них
-    if (ignoreTransparent && balls[i].material.transmission > 0.5) {
+  for (int k = 0; k < count; ++k) {
+    int i = gridSize.x == 0 ? k : texelFetch(gridIndices, first + k).x;
+    // Если это расчет тени, мы игнорируем прозрачные объекты, чтобы свет
+    // проходил сквозь них
+    if (ignoreTransparent && objectTransmission(i) > 0.5) {
       continue;
     }
 
-    float ball = sdSphere(p, balls[i].position, ballRadius);
-    if (ball < min_dist) {
-      min_dist = ball;
-      hitType = 3;
+    vec4 t0 = objectTexel(i, 0);
+    vec4 size = objectTexel(i, 1);
+    float dist;
+    if (int(t0.w) == OBJECT_SPHERE) {
+      dist = sdSphere(p, t0.xyz, size.x);
+    } else {
+      // Коробка в своих осях: поворачиваем точку обратно
+      vec3 local = (p - t0.xyz) * objectRotation(i);
+      dist = sdBox(local, vec3(0.0), size.xyz);
+    }
+
+    if (dist < min_dist) {
+      min_dist = dist;
+      hitType = HIT_OBJECT;
       ballIndex = i;
     }
   }
@@ -121,15 +267,21 @@ float sceneSDF(vec3 p,
 
 // Расчет нормали
 vec3 calcNormal(vec3 p, int hitType, int ballIndex) {
-  // Для сфер используем идеально точную математическую нормаль
-  if (hitType == 3 && ballIndex >= 0) {
-    return normalize(p - balls[ballIndex].position);
+  // Для сфер и коробок нормаль считается аналитически
+  if (hitType == HIT_STATIC) {
+    return boxNormal(p, staticTexel(ballIndex, 0).xyz,
+                     staticRotation(ballIndex),
+                     staticTexel(ballIndex, 1).xyz);
   }
-  // Для стола нормаль всегда смотрит строго вверх
-  if (hitType == 1) {
-    return vec3(0.0, 0.0, 1.0);
+  if (hitType == HIT_OBJECT) {
+    vec4 t0 = objectTexel(ballIndex, 0);
+    if (int(t0.w) == OBJECT_SPHERE) {
+      return normalize(p - t0.xyz);
+    }
+    return boxNormal(p, t0.xyz, objectRotation(ballIndex),
+                     objectTexel(ballIndex, 1).xyz);
   }
-  // Для бортов используем численный градиент
+  // Запасной вариант: численный градиент
   const float h = 0.0005;
   int t1, t2;
   vec2 k = vec2(1, -1);
@@ -147,7 +299,7 @@ vec2 sphereUV(vec3 normal, int ballIndex) {
   if (ballIndex >= 0) {
     // Умножаем на матрицу, чтобы перевести нормаль из мирового пр-ва в
     // локальное
-    localNormal = normal * balls[ballIndex].rotation;
+    localNormal = normal * objectRotation(ballIndex);
   }
 
   float u = 0.75 - atan(localNormal.z, localNormal.x) / (2.0 * 3.14159265);
@@ -157,6 +309,20 @@ vec2 sphereUV(vec3 normal, int ballIndex) {
   return clamp(vec2(0.5) + (vec2(u, v) - 0.5) * 3.0, 0.0, 1.0);
 }
 
+// Мип-уровень текстуры шара по размеру пикселя на поверхности. Неявные
+// производные внутри цикла с ветвлениями не определены, а на шве развёртки
+// они дали бы ложный скачок уровня, поэтому уровень считается явно
+float sphereTextureLod(float dist, float radius) {
+  // Луч строится как view * tanFovHalf + uv, а шаг uv на пиксель равен
+  // 1 / resolution.y, поэтому пиксель виден под углом
+  // 1 / (tanFovHalf * resolution.y)
+  float footprint = dist / (tanFovHalf * resolution.y);
+  // Развёртка растянута в 3 раза: ширина текстуры ложится на треть экватора
+  float texelsPerUnit = float(textureSize(materialTextures, 0).x) * 3.0 /
+                        (2.0 * 3.14159265 * radius);
+  return max(log2(footprint * texelsPerUnit), 0.0);
+}
+
 // Освещение и тени
 vec3 FresnelSchlick(float cosTheta, vec3 F0) {
   return F0 + (1.0 - F0) * pow(clamp(1.0 - cosTheta, 0.0, 1.0), 5.0);
@@ -165,14 +331,20 @@ vec3 FresnelSchlick(float cosTheta, vec3 F0) {
 float getSoftShadow(vec3 ro, vec3 rd, float mint, float maxt, float k) {
   float res = 1.0;
   float t = mint;
-  // 32 итерации — баланс между качеством мягкой тени и FPS
-  for (int i = 0; i < 32; ++i) {
+  // SHADOW_STEPS итераций — баланс между качеством мягкой тени и FPS
+  for (int i = 0; i < SHADOW_STEPS; ++i) {
     int ht, bi;
     float h = sceneSDF(ro + rd * t, ht, bi, true);
     if (h < HIT_THRESHOLD) {
       return 0.0;  // Точка полностью в тени
     }
-    res = min(res, k * h / t);  // k определяет мягкость края
+#if SOFT_SHADOWS
+    // Оценка сетки (HIT_NONE) меньше реального расстояния и дала бы ложную
+    // полутень
+    if (ht != HIT_NONE) {
+      res = min(res, k * h / t);  // k определяет мягкость края
+    }
+#endif
     t += h;
     if (t > maxt) {
       break;
@@ -182,13 +354,15 @@ float getSoftShadow(vec3 ro, vec3 rd, float mint, float maxt, float k) {
 }
 
 // Ray marching
-vec3 rayMarch(vec3 ro, vec3 rd) {
+vec3 rayMarch(vec3 ro, vec3 rd, out vec2 primaryHit) {
+  primaryHit = vec2(MAX_TRACE_DIST, 0.0);
   vec3 accumulatedColor = vec3(0.0);  // Итоговый цвет пикселя
   vec3 throughput = vec3(1.0);        // "Энергия" луча
+  float pathLength = 0.0;             // Путь луча до текущего отскока
 
   for (int bounce = 0; bounce < MAX_BOUNCES; ++bounce) {
     float t = 0.01;  // Начальный отступ луча от поверхности
-    int hitType = 0;
+    int hitType = HIT_NONE;
     int ballIndex = -1;
     bool hit = false;
 
@@ -212,6 +386,12 @@ vec3 rayMarch(vec3 ro, vec3 rd) {
 
     if (hit) {
       vec3 p = ro + rd * t;
+      pathLength += t;
+      if (bounce == 0) {
+        // Объект кодируется типом попадания и индексом: у неподвижных
+        // коробок и подвижных объектов индексы независимы
+        primaryHit = vec2(t, float(hitType * 65536 + ballIndex + 1));
+      }
       vec3 normal = calcNormal(p, hitType, ballIndex);
 
       // Проверяем, луч входит в объект или выходит из него
@@ -220,23 +400,22 @@ vec3 rayMarch(vec3 ro, vec3 rd) {
 
       // Определение свойств материала в точке удара
       BallMaterial mat;
-      if (hitType == 1) {  // Стол
-        mat.baseColor = vec3(0.05, 0.35, 0.05);
-        mat.roughness = 0.5;
-        mat.transmission = 0.0;
-        mat.metallic = 0.0;
-      } else if (hitType == 2) {  // Борта
-        mat.baseColor = vec3(0.15, 0.08, 0.04);
-        mat.roughness = 0.2;
-        mat.transmission = 0.0;
-        mat.metallic = 0.0;
-      } else {  // Шары
-        mat = balls[ballIndex].material;
-        if (mat.textureID >= 0) {
-          mat.baseColor = texture(ballTextures[mat.textureID],
-                                  sphereUV(hitNormal, ballIndex))
-                              .rgb;
+      if (hitType == HIT_STATIC) {
+        mat = staticMaterial(ballIndex);
+      } else {
+        mat = objectMaterial(ballIndex);
+#if MATERIAL_TEXTURES
+        // Текстуры натягиваются только на сферы
+        if (mat.textureID >= 0 &&
+            int(objectTexel(ballIndex, 0).w) == OBJECT_SPHERE) {
+          vec2 uv = sphereUV(hitNormal, ballIndex);
+          float lod =
+              sphereTextureLod(pathLength, objectTexel(ballIndex, 1).x);
+          mat.baseColor =
+              textureLod(materialTextures, vec3(uv, float(mat.textureID)), lod)
+                  .rgb;
         }
+#endif
       }
 
       // Расчет освещения (Прямой свет)
@@ -263,6 +442,7 @@ vec3 rayMarch(vec3 ro, vec3 rd) {
 
       // Вычисление направления для следующего "отскока" луча
       if (mat.transmission > 0.5) {
+#if REFRACTION
         // Преломление
         float eta = entering ? (1.0 / mat.refraction) : mat.refraction;
         vec3 refrDir = refract(rd, hitNormal, eta);
@@ -276,6 +456,11 @@ vec3 rayMarch(vec3 ro, vec3 rd) {
           rd = reflect(rd, hitNormal);
           ro = p + hitNormal * SURFACE_BIAS;
         }
+#else
+        // Без преломления луч проходит объект насквозь, не отклоняясь
+        ro = p + rd * SURFACE_BIAS;
+        throughput *= mat.baseColor;
+#endif
       } else {
         // Отражение
         rd = reflect(rd, hitNormal);
@@ -307,6 +492,8 @@ void main() {
       normalize(cameraRight * uv.x + cameraUp * uv.y + cameraView * tanFovHalf);
 
   // Запуск рендера
-  vec3 color = rayMarch(cameraPos, rd);
+  vec2 primaryHit;
+  vec3 color = rayMarch(cameraPos, rd, primaryHit);
   FragColor = vec4(color, 1.0);
+  SceneData = primaryHit;
 }
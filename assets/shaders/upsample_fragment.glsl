@@ -0,0 +1,53 @@
+#version 330 core
+// Увеличение кадра raymarch-прохода до разрешения окна.
+// Совместный билатеральный фильтр: четыре ближайших текселя смешиваются
+// билинейно, но вес соседа падает, если он лежит на другом объекте или
+// заметно дальше/ближе опорного текселя. Так силуэты шаров и бортов
+// остаются резкими, а не размываются в соседний объект
+out vec4 FragColor;
+in vec2 TexCoord;
+
+uniform sampler2D sceneColor;  // Цвет в пониженном разрешении
+uniform sampler2D sceneData;   // x - расстояние до попадания, y - объект
+uniform vec2 sourceSize;       // Размер кадра raymarch-прохода
+
+const float DEPTH_SIGMA = 0.05;  // Допустимая относительная разница глубин
+const float OTHER_OBJECT_WEIGHT = 0.02;  // Вес текселя чужого объекта
+
+void main() {
+  // Позиция в текселях исходного кадра относительно центров текселей
+  ivec2 size = ivec2(sourceSize);
+  vec2 pos = TexCoord * sourceSize - 0.5;
+  ivec2 base = ivec2(floor(pos));
+  vec2 f = pos - vec2(base);
+
+  // Опорный тексель - ближайший к пикселю
+  ivec2 nearest = clamp(ivec2(floor(pos + 0.5)), ivec2(0), size - 1);
+  vec2 reference = texelFetch(sceneData, nearest, 0).xy;
+
+  vec3 color = vec3(0.0);
+  float totalWeight = 0.0;
+  for (int i = 0; i < 4; ++i) {
+    ivec2 offset = ivec2(i & 1, i >> 1);
+    ivec2 texel = clamp(base + offset, ivec2(0), size - 1);
+    vec2 data = texelFetch(sceneData, texel, 0).xy;
+
+    // Билинейный вес
+    vec2 w2 = mix(1.0 - f, f, vec2(offset));
+    float weight = w2.x * w2.y;
+
+    // Разрыв глубины и смена объекта - признаки границы
+    float depthDelta = abs(data.x - reference.x) / max(reference.x, 1e-3);
+    weight *= exp(-depthDelta / DEPTH_SIGMA);
+    if (data.y != reference.y) {
+      weight *= OTHER_OBJECT_WEIGHT;
+    }
+
+    color += texelFetch(sceneColor, texel, 0).rgb * weight;
+    totalWeight += weight;
+  }
+
+  // Опорный тексель входит в четвёрку с билинейным весом не меньше 1/4,
+  // поэтому сумма весов не нулевая
+  FragColor = vec4(color / totalWeight, 1.0);
+}
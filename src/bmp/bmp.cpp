@@ -15,23 +15,9 @@ BMP::BMP(const RawImage& raw) {
   info_.fileInfo.fSize =
       info_.fileInfo.fDataOffset + info_.imageInfo.fSizeImage;
 
-  dib.resize(info_.imageInfo.fSizeImage);
-
-  const uint32_t line_bytes =
-      info_.imageInfo.fSizeImage / info_.imageInfo.fHeight;
-  for (uint32_t x = 0; x < info_.imageInfo.fWidth; x++) {
-    for (uint32_t y = 0; y < info_.imageInfo.fHeight; y++) {
-      dib[sizeof(RGB) * x + line_bytes * y + 0] =
-          raw.raw_data()[sizeof(RGB) * x +
-                         y * info_.imageInfo.fWidth * sizeof(RGB) + 0];
-      dib[sizeof(RGB) * x + line_bytes * y + 1] =
-          raw.raw_data()[sizeof(RGB) * x +
-                         y * info_.imageInfo.fWidth * sizeof(RGB) + 1];
-      dib[sizeof(RGB) * x + line_bytes * y + 2] =
-          raw.raw_data()[sizeof(RGB) * x +
-                         y * info_.imageInfo.fWidth * sizeof(RGB) + 2];
-    }
-  }
+  // Строки RawImage уже лежат снизу вверх и выровнены по 4 байта, как в
+  // BMP, поэтому данные копируются как есть
+  dib.assign(raw.raw_data(), raw.raw_data() + raw.raw_size());
 }
 
 const bmpInfo& BMP::getInfo() const {
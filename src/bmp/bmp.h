@@ -35,6 +35,8 @@ struct bmpInfo {
 
 class RawImage;
 
+// BMP в памяти целиком. Для больших кадров - ImageWriter, который пишет
+// файл построчно
 class BMP {
  public:
   BMP(const RawImage& raw);
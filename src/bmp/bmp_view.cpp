@@ -0,0 +1,77 @@
+#include "bmp_view.h"
+#include <cstring>
+#include <iostream>
+#include "bmp.h"
+
+// Допустимый размер стороны: защита от переполнения при битых заголовках
+constexpr int64_t kMaxDimension = 1 << 15;
+
+bool BMPView::Open(const std::string& filename) {
+  Close();
+  if (!file_.Open(filename)) {
+    std::cerr << "Failed to open BMP file: " << filename << std::endl;
+    return false;
+  }
+
+  auto fail = [&](const char* reason) {
+    std::cerr << "Invalid BMP file '" << filename << "': " << reason
+              << std::endl;
+    Close();
+    return false;
+  };
+
+  if (file_.GetSize() < sizeof(bmpInfo)) {
+    return fail("file is too small");
+  }
+  // Заголовок копируется: в отображении он может быть не выровнен
+  bmpInfo info;
+  std::memcpy(&info, file_.GetData(), sizeof(bmpInfo));
+
+  if (info.fileInfo.fSignature != 19778) {  // 'BM'
+    return fail("invalid signature");
+  }
+  if (info.imageInfo.fSize < sizeof(cfi)) {
+    return fail("unsupported info header");
+  }
+  if (info.imageInfo.fPlanes != 1 || info.imageInfo.fBitCount != 24) {
+    return fail("only 24-bit images are supported");
+  }
+  if (info.imageInfo.fCompression != 0) {  // BI_RGB
+    return fail("compressed images are not supported");
+  }
+
+  // Высота со знаком: отрицательная - строки хранятся сверху вниз
+  int64_t width = static_cast<int32_t>(info.imageInfo.fWidth);
+  int64_t height = static_cast<int32_t>(info.imageInfo.fHeight);
+  topDown_ = height < 0;
+  height = topDown_ ? -height : height;
+  if (width <= 0 || height <= 0 || width > kMaxDimension ||
+      height > kMaxDimension) {
+    return fail("invalid dimensions");
+  }
+
+  width_ = static_cast<uint32_t>(width);
+  height_ = static_cast<uint32_t>(height);
+  stride_ = ((width_ * 24 + 31) / 32) * 4;
+  size_t offset = info.fileInfo.fDataOffset;
+  if (offset < sizeof(bmpInfo) || offset > file_.GetSize() ||
+      file_.GetSize() - offset < stride_ * height_) {
+    return fail("pixel data is truncated");
+  }
+  pixels_ = file_.GetData() + offset;
+  return true;
+}
+
+void BMPView::Close() {
+  file_.Close();
+  pixels_ = nullptr;
+  width_ = 0;
+  height_ = 0;
+  stride_ = 0;
+  topDown_ = false;
+}
+
+const uint8_t* BMPView::GetRow(uint32_t y) const {
+  uint32_t row = topDown_ ? height_ - 1 - y : y;
+  return pixels_ + stride_ * row;
+}
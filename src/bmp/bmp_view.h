@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "core/mapped_file.h"
+
+// Несжатый 24-битный BMP, отображённый в память. Заголовки проверяются
+// при открытии, строки пикселей читаются прямо из отображения без
+// копирования. Строки нумеруются снизу вверх, как в RawImage, независимо
+// от порядка хранения в файле
+class BMPView {
+ public:
+  // Открывает и проверяет файл. При ошибке пишет причину в std::cerr и
+  // возвращает false
+  bool Open(const std::string& filename);
+  void Close();
+
+  bool IsOpen() const { return pixels_ != nullptr; }
+  uint32_t GetWidth() const { return width_; }
+  uint32_t GetHeight() const { return height_; }
+
+  // Длина строки в байтах (выровнена по 4 байта)
+  size_t GetStride() const { return stride_; }
+
+  // Строка y (0 - нижняя), BGR
+  const uint8_t* GetRow(uint32_t y) const;
+
+  // Все строки подряд снизу вверх - или nullptr, если файл хранит их
+  // сверху вниз (отрицательная высота)
+  const uint8_t* GetPixels() const { return topDown_ ? nullptr : pixels_; }
+
+  bool IsTopDown() const { return topDown_; }
+
+  // Подгружает файл с диска заранее (см. MappedFile::Prefetch)
+  void Prefetch() const { file_.Prefetch(); }
+
+ private:
+  MappedFile file_;
+  const uint8_t* pixels_ = nullptr;
+  uint32_t width_ = 0;
+  uint32_t height_ = 0;
+  size_t stride_ = 0;
+  bool topDown_ = false;
+};
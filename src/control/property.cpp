@@ -7,3 +7,11 @@ void PositionProperty::SetPosition(const vec3& position) {
 const vec3& PositionProperty::GetPosition() const {
   return position_;
 }
+
+void OrientationProperty::SetOrientation(const quat& orientation) {
+  orientation_ = orientation;
+}
+
+const quat& OrientationProperty::GetOrientation() const {
+  return orientation_;
+}
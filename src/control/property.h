@@ -11,3 +11,13 @@ class PositionProperty {
 
   void SetPosition(const vec3& position);
 };
+
+class OrientationProperty {
+ private:
+  quat orientation_;
+
+ public:
+  const quat& GetOrientation() const;
+
+  void SetOrientation(const quat& orientation);
+};
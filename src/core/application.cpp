@@ -2,14 +2,30 @@
 #include <iomanip>
 #include <iostream>
 #include <sstream>
+#include "gl/shader_cache.h"
 #include "physics/physics_body.h"
 #include "render/material_converter.h"
 #include "render/raw_image.h"
 #include "render/texture_manager.h"
 
-Application::Application() : window_(nullptr), running_(false) {}
+// Сколько байт текстур загружается в GPU за кадр
+constexpr size_t kTextureUploadBudget = 1 << 20;
+
+Application::Application(const ApplicationOptions& options)
+    : window_(nullptr),
+      running_(false),
+      options_(options),
+      PHYSICS_UPDATES_PER_SECOND(options.physicsRate),
+      FIXED_DELTA_TIME(1.0f / options.physicsRate) {}
 
 Application::~Application() {
+  // Поток физики обращается к сцене, останавливаем его первым
+  simulationThread_.reset();
+  // Текстуры удаляются, пока жив контекст OpenGL
+  if (options_.textureReport) {
+    TextureManager::GetInstance().PrintMemoryReport(std::cerr);
+  }
+  TextureManager::GetInstance().Shutdown();
   if (window_) {
     SDL_DestroyWindow(window_);
   }
@@ -43,15 +59,49 @@ bool Application::Initialize() {
     return false;
   }
 
-  // Загрузка шейдеров для raymarching-рендеринга
-  raymarchShader_.emplace("assets/shaders/vertex.glsl",
-                          "assets/shaders/raymarch_fragment.glsl");
-  if (raymarchShader_->getID() == 0) {
+  // Бинарники программ кэшируются на диске между запусками
+  ShaderCache::GetInstance().SetDirectory(options_.shaderCacheDirectory);
+
+  // Загрузка шейдеров для raymarching-рендеринга. Варианты компилируются
+  // по требованию; базовый собираем сразу, чтобы проверить исходники
+  raymarchShaders_.emplace(
+      "assets/shaders/vertex.glsl", "assets/shaders/raymarch_fragment.glsl",
+      [](const Shader& shader) {
+        shader.bindUniformBlock("ObjectBlock", GLRenderer::kObjectBlockBinding);
+        MaterialConverter::InitShaderSamplers(shader);
+      });
+  shaderVariant_ = ShaderVariant::ForQuality(options_.quality);
+  if (!raymarchShaders_->Get(shaderVariant_)) {
     std::cerr << "Failed to compile/link raymarch shader" << std::endl;
     return false;
   }
 
+  // Динамическое разрешение: масштаб подбирается по времени GPU, начиная
+  // с заданного
+  renderScale_ = options_.renderScale;
+  if (options_.targetFPS > 0.0f) {
+    DynamicResolution::Settings settings;
+    settings.targetMs = 1000.0 / options_.targetFPS;
+    dynamicResolution_.emplace(settings, renderScale_);
+    gpuTimer_ = std::make_unique<GpuTimer>();
+  }
+
+  // Проход увеличения нужен только при пониженном разрешении
+  if (renderScale_ < 1.0f || dynamicResolution_) {
+    upsampleShader_.emplace("assets/shaders/vertex.glsl",
+                            "assets/shaders/upsample_fragment.glsl");
+    if (upsampleShader_->getID() == 0) {
+      std::cerr << "Failed to compile upsample shader, rendering at full "
+                   "resolution"
+                << std::endl;
+      upsampleShader_.reset();
+      dynamicResolution_.reset();
+      gpuTimer_.reset();
+    }
+  }
+
   // Инициализация менеджера текстур и загрузка основной сцены из JSON
+  TextureManager::GetInstance().SetBudget(options_.textureBudget);
   TextureManager::GetInstance().Initialize();
   sceneLoader_.emplace(SceneLoader::Load("assets/scene/billiard.json"));
 
@@ -93,9 +143,15 @@ bool Application::Initialize() {
   dummyTexture_ = std::make_unique<Texture>(dummy);
   dummyTexture_->createTexture();
 
-  // Настройка материалов, текстур и uniform'ов для бильярдных шаров
-  if (raymarchShader_) {
-    MaterialConverter::InitShaderSamplers(*raymarchShader_);
+  // Начальное состояние для интерполяции
+  sceneLoader_->GetScene().CaptureSnapshot(currentState_);
+  previousState_ = currentState_;
+
+  // Физика в отдельном потоке (по запросу)
+  if (options_.threadedSimulation) {
+    simulationThread_ = std::make_unique<SimulationThread>(
+        sceneLoader_->GetScene(), FIXED_DELTA_TIME);
+    simulationThread_->Start();
   }
 
   // Данные для расчета FPS
@@ -132,6 +188,11 @@ void Application::CalculateFPS(Uint32 now) {
     std::ostringstream title;
     title << "Game Engine | FPS: " << std::fixed << std::setprecision(1)
           << currentFPS_;
+    if (dynamicResolution_) {
+      title << " | GPU: " << dynamicResolution_->GetSmoothedMs()
+            << " ms | Scale: " << std::setprecision(2)
+            << dynamicResolution_->GetScale();
+    }
     SDL_SetWindowTitle(window_, title.str().c_str());
   }
 }
@@ -148,45 +209,104 @@ void Application::Update(float deltaTime) {
     cameraController_->HandleInput(deltaTime);
   }
 
+  // В многопоточном режиме физика идёт в своём потоке
+  if (simulationThread_) {
+    timeAccumulator_ = 0.0f;
+    return;
+  }
+
   // Цикл обновления физики
   while (timeAccumulator_ >= FIXED_DELTA_TIME) {
     if (sceneLoader_) {
-      sceneLoader_->GetScene().UpdatePhysics(FIXED_DELTA_TIME);
+      Scene& scene = sceneLoader_->GetScene();
+      scene.StepPhysics(FIXED_DELTA_TIME);
+      std::swap(previousState_, currentState_);
+      scene.CaptureSnapshot(currentState_);
     }
     timeAccumulator_ -= FIXED_DELTA_TIME;
   }
 }
 
 void Application::Render() {
-  if (!raymarchShader_ || !sceneLoader_ || !camera_) {
+  if (!raymarchShaders_ || !sceneLoader_ || !camera_) {
     return;
   }
 
-  // Обновление uniform'ов всех объектов
-  renderer_->UpdateUniforms(sceneLoader_->GetScene(), *raymarchShader_);
+  // Положения объектов между двумя последними шагами физики: остаток
+  // аккумулятора показывает, какая доля следующего шага уже прошла
+  if (simulationThread_) {
+    simulationThread_->SyncRenderState();
+  } else {
+    float alpha = timeAccumulator_ / FIXED_DELTA_TIME;
+    sceneLoader_->GetScene().ApplySnapshot(previousState_, currentState_,
+                                           alpha);
+  }
+
+  // Разрешение берём у окна: на HiDPI-экранах оно больше размера окна
+  int drawableWidth = 0;
+  int drawableHeight = 0;
+  SDL_GL_GetDrawableSize(window_, &drawableWidth, &drawableHeight);
+
+  // Масштаб по времени GPU кадров, отрисованных несколько кадров назад
+  if (gpuTimer_ && dynamicResolution_) {
+    double gpuMs = 0.0;
+    if (gpuTimer_->Poll(gpuMs)) {
+      renderScale_ = dynamicResolution_->Update(gpuMs);
+    }
+  }
+  if (upsampleShader_) {
+    float maxScale = dynamicResolution_ ? 1.0f : renderScale_;
+    renderer_->SetViewport(drawableWidth, drawableHeight, renderScale_,
+                           maxScale);
+  } else {
+    renderer_->SetViewport(drawableWidth, drawableHeight, 1.0f);
+  }
+
+  // Догружаем готовые текстуры, не тормозя кадр
+  TextureManager::GetInstance().Update(kTextureUploadBudget);
 
-  raymarchShader_->use();
+  // Обновление uniform'ов всех объектов
+  renderer_->UpdateUniforms(sceneLoader_->GetScene());
+
+  // Вариант шейдера с числом статических коробок сцены; если он не
+  // собрался, рисуем базовым
+  ShaderVariant variant = shaderVariant_;
+  variant.staticCount = renderer_->GetStaticCount();
+  const Shader* shader = raymarchShaders_->Get(variant);
+  if (!shader) {
+    shader = raymarchShaders_->Get(shaderVariant_);
+  }
+  shader->use();
 
   // Передача параметров камеры в шейдер каждый кадр
   const Camera& cam = *camera_;
   vec3 right = normalize(cross(cam.GetViewVec(), cam.GetUpVec()));
-  raymarchShader_->setVec3("cameraPos", cam.GetPosition());
-  raymarchShader_->setVec3("cameraView", cam.GetViewVec());
-  raymarchShader_->setVec3("cameraUp", cam.GetUpVec());
-  raymarchShader_->setVec3("cameraRight", right);
-  raymarchShader_->setFloat("tanFovHalf",
-                            std::tan(cam.GetFOV() * 3.14159265f / 360.0f));
-  raymarchShader_->setVec2("resolution", 800.0f, 600.0f);
+  shader->setVec3("cameraPos", cam.GetPosition());
+  shader->setVec3("cameraView", cam.GetViewVec());
+  shader->setVec3("cameraUp", cam.GetUpVec());
+  shader->setVec3("cameraRight", right);
+  shader->setFloat("tanFovHalf",
+                   std::tan(cam.GetFOV() * 3.14159265f / 360.0f));
+  shader->setVec2("resolution",
+                  static_cast<float>(renderer_->GetRenderWidth()),
+                  static_cast<float>(renderer_->GetRenderHeight()));
 
   // Настройка освещения (точечный свет + глобальное направленное)
-  raymarchShader_->setVec3("pointLightPos", vec3(0.0f, 2.7f, 10.0f));
-  raymarchShader_->setVec3("pointLightColor", vec3(1.0f, 0.94f, 0.78f));
-  raymarchShader_->setFloat("pointLightBrightness", 2.0f);
-  raymarchShader_->setVec3("globalLightDir", vec3(0.0f, -1.0f, -0.5f));
-  raymarchShader_->setVec3("globalLightColor", vec3(1.0f, 1.0f, 1.0f));
-  raymarchShader_->setFloat("globalLightBrightness", 0.3f);
+  shader->setVec3("pointLightPos", vec3(0.0f, 2.7f, 10.0f));
+  shader->setVec3("pointLightColor", vec3(1.0f, 0.94f, 0.78f));
+  shader->setFloat("pointLightBrightness", 2.0f);
+  shader->setVec3("globalLightDir", vec3(0.0f, -1.0f, -0.5f));
+  shader->setVec3("globalLightColor", vec3(1.0f, 1.0f, 1.0f));
+  shader->setFloat("globalLightBrightness", 0.3f);
 
   // Рендеринг сцены через полноэкранный квад и raymarch-шейдер
-  renderer_->Render(*raymarchShader_, *dummyTexture_);
+  if (gpuTimer_) {
+    gpuTimer_->Begin();
+  }
+  renderer_->Render(*shader, *dummyTexture_,
+                    upsampleShader_ ? &*upsampleShader_ : nullptr);
+  if (gpuTimer_) {
+    gpuTimer_->End();
+  }
   SDL_GL_SwapWindow(window_);
 }
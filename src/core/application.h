@@ -7,16 +7,40 @@
 #include <vector>
 
 #include "control/camera_controller.h"
+#include "dynamic_resolution.h"
 #include "gl/gl_renderer.h"
+#include "gl/gpu_timer.h"
 #include "gl/shader.h"
+#include "gl/shader_permutations.h"
 #include "input/input_controller.h"
 #include "render/camera.h"
 #include "render/scene_loader.h"
 #include "render/texture.h"
+#include "render/texture_manager.h"
+#include "simulation_thread.h"
+
+// Параметры запуска приложения
+struct ApplicationOptions {
+  bool threadedSimulation = false;  // Физика в отдельном потоке
+  int physicsRate = 60;             // Частота шагов физики (Гц)
+
+  // Качество raymarch-шейдера
+  ShaderQuality quality = ShaderQuality::High;
+  // Доля разрешения окна, в которой идёт raymarch (1 - полное)
+  float renderScale = 1.0f;
+  // Целевая частота кадров для динамического разрешения (0 - выключено)
+  float targetFPS = 0.0f;
+  // Каталог кэша бинарников шейдеров (пустой - без кэша)
+  std::string shaderCacheDirectory = "shader_cache";
+  // Ограничения памяти текстур
+  TextureBudget textureBudget;
+  // Вывести память текстур при выходе
+  bool textureReport = false;
+};
 
 class Application {
  public:
-  Application();
+  explicit Application(const ApplicationOptions& options = {});
   ~Application();
 
   // Инициализация окна, контекста, сцены и ресурсов
@@ -38,6 +62,7 @@ class Application {
 
   // Состояние приложения
   bool running_;
+  ApplicationOptions options_;
 
   // Ввод и камера
   InputController input_;
@@ -48,14 +73,28 @@ class Application {
   std::optional<SceneLoader> sceneLoader_;
 
   // Шейдеры и текстуры
-  std::optional<Shader> raymarchShader_;
+  // Варианты raymarch-шейдера; текущий выбирается каждый кадр по
+  // качеству и числу статических коробок сцены
+  std::optional<ShaderPermutations> raymarchShaders_;
+  ShaderVariant shaderVariant_;
+  std::optional<Shader> upsampleShader_;  // Увеличение кадра до окна
+
+  // Динамическое разрешение по замерам времени GPU
+  std::unique_ptr<GpuTimer> gpuTimer_;
+  std::optional<DynamicResolution> dynamicResolution_;
+  float renderScale_ = 1.0f;
   std::unique_ptr<Texture> dummyTexture_;
 
   // Данные для цикла и физики
-  const int PHYSICS_UPDATES_PER_SECOND = 60;
-  const float FIXED_DELTA_TIME = 1.0f / 60.0f;
+  const int PHYSICS_UPDATES_PER_SECOND;
+  const float FIXED_DELTA_TIME;
   float timeAccumulator_ = 0.0f;
 
+  // Два последних состояния физики для интерполяции при отрисовке
+  PhysicsSnapshot previousState_;
+  PhysicsSnapshot currentState_;
+  std::unique_ptr<SimulationThread> simulationThread_;
+
   // Данные FPS
   Uint32 lastTime_ = 0;
   Uint32 lastFPSTime_ = 0;
@@ -0,0 +1,45 @@
+#include "dynamic_resolution.h"
+#include <algorithm>
+#include <cmath>
+
+// Вес нового замера в экспоненциальном сглаживании
+constexpr double kSmoothing = 0.2;
+
+DynamicResolution::DynamicResolution(const Settings& settings,
+                                     float initialScale)
+    : settings_(settings),
+      scale_(std::clamp(initialScale, settings.minScale, settings.maxScale)) {}
+
+float DynamicResolution::Update(double gpuMs) {
+  if (gpuMs <= 0.0) {
+    return scale_;
+  }
+  smoothedMs_ = smoothedMs_ < 0.0
+                    ? gpuMs
+                    : smoothedMs_ + (gpuMs - smoothedMs_) * kSmoothing;
+
+  // Замеры отстают на несколько кадров: ждём, пока они отразят новый
+  // масштаб, иначе контроллер раскачивается
+  if (framesToWait_ > 0) {
+    --framesToWait_;
+    return scale_;
+  }
+
+  double ratio = settings_.targetMs / smoothedMs_;
+  if (std::abs(ratio - 1.0) <= settings_.tolerance) {
+    return scale_;
+  }
+
+  // Время пропорционально площади, поэтому масштаб - корню из отношения
+  float desired = scale_ * static_cast<float>(std::sqrt(ratio));
+  desired = std::clamp(desired, scale_ - settings_.maxStep,
+                       scale_ + settings_.maxStep);
+  desired = std::clamp(desired, settings_.minScale, settings_.maxScale);
+  if (desired != scale_) {
+    // Прежнее сглаженное время относилось к старому масштабу
+    smoothedMs_ *= (desired * desired) / (scale_ * scale_);
+    scale_ = desired;
+    framesToWait_ = settings_.cooldown;
+  }
+  return scale_;
+}
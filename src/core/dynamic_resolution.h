@@ -0,0 +1,30 @@
+#pragma once
+
+// Подбирает долю разрешения raymarch-прохода так, чтобы время GPU на кадр
+// держалось около целевого. Стоимость прохода пропорциональна числу
+// пикселей, т.е. квадрату масштаба
+class DynamicResolution {
+ public:
+  struct Settings {
+    double targetMs = 16.0;   // Целевое время GPU на кадр
+    float minScale = 0.25f;   // Нижняя граница масштаба
+    float maxScale = 1.0f;    // Верхняя граница масштаба
+    double tolerance = 0.05;  // Допустимое отклонение без подстройки
+    float maxStep = 0.1f;     // Наибольшее изменение масштаба за раз
+    int cooldown = 4;         // Кадры запаздывания замеров после смены
+  };
+
+  DynamicResolution(const Settings& settings, float initialScale);
+
+  // Учитывает очередной замер времени GPU и возвращает новый масштаб
+  float Update(double gpuMs);
+
+  float GetScale() const { return scale_; }
+  double GetSmoothedMs() const { return smoothedMs_; }
+
+ private:
+  Settings settings_;
+  float scale_;
+  double smoothedMs_ = -1.0;  // Сглаженное время (-1 - замеров не было)
+  int framesToWait_ = 0;
+};
@@ -0,0 +1,144 @@
+#include "job_system.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+// Индекс потока в пуле; у внешних потоков остаётся 0
+static thread_local size_t currentWorker = 0;
+
+// Состояние одного вызова ParallelFor, общее для всех участников
+struct RangeJob {
+  const JobSystem::RangeFunction* function = nullptr;
+  size_t count = 0;
+  size_t grain = 1;
+  size_t chunks = 0;
+  std::atomic<size_t> nextChunk{0};
+  std::atomic<size_t> finishedChunks{0};
+};
+
+// Забирает и выполняет куски, пока они не закончатся
+static void RunChunks(RangeJob& job) {
+  size_t worker = JobSystem::CurrentWorker();
+  for (;;) {
+    size_t chunk = job.nextChunk.fetch_add(1, std::memory_order_relaxed);
+    if (chunk >= job.chunks) {
+      return;
+    }
+    size_t begin = chunk * job.grain;
+    size_t end = std::min(begin + job.grain, job.count);
+    (*job.function)(begin, end, worker);
+    job.finishedChunks.fetch_add(1, std::memory_order_release);
+  }
+}
+
+JobSystem& JobSystem::GetInstance() {
+  static JobSystem instance;
+  return instance;
+}
+
+JobSystem::JobSystem() {
+  SetThreadCount(0);
+}
+
+JobSystem::~JobSystem() {
+  StopWorkers();
+}
+
+void JobSystem::SetThreadCount(size_t count) {
+  if (count == 0) {
+    count = std::max(1u, std::thread::hardware_concurrency());
+  }
+  StopWorkers();
+  StartWorkers(count - 1);  // Вызывающий поток тоже выполняет работу
+}
+
+size_t JobSystem::CurrentWorker() {
+  return currentWorker;
+}
+
+void JobSystem::ParallelFor(size_t count,
+                            size_t grain,
+                            const RangeFunction& function) {
+  if (count == 0) {
+    return;
+  }
+  grain = std::max<size_t>(grain, 1);
+  size_t chunks = (count + grain - 1) / grain;
+
+  // Нечего делить - выполняем на месте
+  if (chunks == 1 || workers_.empty()) {
+    function(0, count, CurrentWorker());
+    return;
+  }
+
+  auto job = std::make_shared<RangeJob>();
+  job->function = &function;
+  job->count = count;
+  job->grain = grain;
+  job->chunks = chunks;
+
+  size_t helpers = std::min(chunks - 1, workers_.size());
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < helpers; ++i) {
+      tasks_.push_back([job]() { RunChunks(*job); });
+    }
+  }
+  condition_.notify_all();
+
+  RunChunks(*job);
+
+  // Ждём куски, которые ещё выполняются в рабочих потоках
+  while (job->finishedChunks.load(std::memory_order_acquire) < chunks) {
+    std::this_thread::yield();
+  }
+}
+
+void JobSystem::Submit(std::function<void()> task) {
+  if (workers_.empty()) {
+    task();
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(std::move(task));
+  }
+  condition_.notify_one();
+}
+
+void JobSystem::StartWorkers(size_t count) {
+  stopping_ = false;
+  workers_.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    workers_.emplace_back(&JobSystem::WorkerLoop, this, i + 1);
+  }
+}
+
+void JobSystem::StopWorkers() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  condition_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+}
+
+void JobSystem::WorkerLoop(size_t index) {
+  currentWorker = index;
+  for (;;) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      condition_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+      if (tasks_.empty()) {
+        return;  // Остановка: очередь разобрана
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+  }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Пул рабочих потоков для параллельных циклов
+class JobSystem {
+ public:
+  // Тело цикла: обрабатывает индексы [begin, end) в потоке worker
+  using RangeFunction =
+      std::function<void(size_t begin, size_t end, size_t worker)>;
+
+  static JobSystem& GetInstance();
+
+  // Задаёт число потоков вместе с вызывающим (0 - по числу ядер).
+  // Вызывать только когда в пуле нет работы
+  void SetThreadCount(size_t count);
+
+  // Число потоков, участвующих в ParallelFor (рабочие + вызывающий)
+  size_t GetThreadCount() const { return workers_.size() + 1; }
+
+  // Индекс текущего потока: 0 - внешний поток, 1..N - рабочие.
+  // Подходит для выбора буфера потока размером GetThreadCount()
+  static size_t CurrentWorker();
+
+  // Делит [0, count) на куски по grain индексов и выполняет их
+  // параллельно; вызывающий поток тоже участвует. Возвращает управление
+  // после завершения всех кусков
+  void ParallelFor(size_t count, size_t grain, const RangeFunction& function);
+
+  // Ставит задачу в очередь и сразу возвращает управление. Без рабочих
+  // потоков задача выполняется на месте
+  void Submit(std::function<void()> task);
+
+ private:
+  JobSystem();
+  ~JobSystem();
+
+  JobSystem(const JobSystem&) = delete;
+  JobSystem& operator=(const JobSystem&) = delete;
+
+  void StartWorkers(size_t count);
+  void StopWorkers();
+  void WorkerLoop(size_t index);
+
+  std::vector<std::thread> workers_;
+  std::deque<std::function<void()>> tasks_;
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  bool stopping_ = false;
+};
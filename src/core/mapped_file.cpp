@@ -0,0 +1,129 @@
+#include "mapped_file.h"
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+  Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+  *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+  if (this != &other) {
+    Close();
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+#ifdef _WIN32
+    std::swap(file_, other.file_);
+    std::swap(mapping_, other.mapping_);
+#endif
+  }
+  return *this;
+}
+
+void MappedFile::Prefetch() const {
+  // Байта со страницы достаточно, чтобы ОС прочитала её с диска
+  constexpr size_t kPageSize = 4096;
+  volatile uint8_t sink = 0;
+  for (size_t offset = 0; offset < size_; offset += kPageSize) {
+    sink = sink ^ data_[offset];
+  }
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::string& filename) {
+  Close();
+  HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING,
+                            FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+    CloseHandle(file);
+    return false;
+  }
+  HANDLE mapping =
+      CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mapping) {
+    CloseHandle(file);
+    return false;
+  }
+  void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (!view) {
+    CloseHandle(mapping);
+    CloseHandle(file);
+    return false;
+  }
+  file_ = file;
+  mapping_ = mapping;
+  data_ = static_cast<const uint8_t*>(view);
+  size_ = static_cast<size_t>(size.QuadPart);
+  return true;
+}
+
+void MappedFile::Close() {
+  if (data_) {
+    UnmapViewOfFile(data_);
+  }
+  if (mapping_) {
+    CloseHandle(mapping_);
+  }
+  if (file_) {
+    CloseHandle(file_);
+  }
+  data_ = nullptr;
+  size_ = 0;
+  file_ = nullptr;
+  mapping_ = nullptr;
+}
+
+#else
+
+bool MappedFile::Open(const std::string& filename) {
+  Close();
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size == 0) {
+    close(fd);
+    return false;
+  }
+  size_t size = static_cast<size_t>(info.st_size);
+  void* view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);  // Отображение остаётся действительным без дескриптора
+  if (view == MAP_FAILED) {
+    return false;
+  }
+  // Файл читается подряд - просим ОС подгружать страницы заранее
+  madvise(view, size, MADV_SEQUENTIAL);
+  data_ = static_cast<const uint8_t*>(view);
+  size_ = size;
+  return true;
+}
+
+void MappedFile::Close() {
+  if (data_) {
+    munmap(const_cast<uint8_t*>(data_), size_);
+  }
+  data_ = nullptr;
+  size_ = 0;
+}
+
+#endif
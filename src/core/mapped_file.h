@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Файл, отображённый в память только для чтения. Страницы подгружает
+// ОС по мере обращения, поэтому данные не копируются через буферы
+// потоков ввода
+class MappedFile {
+ public:
+  MappedFile() = default;
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+
+  // Отображает файл целиком. Возвращает false, если файл не открылся
+  // или пуст
+  bool Open(const std::string& filename);
+  void Close();
+
+  // Подгружает все страницы файла сейчас, а не при первом обращении.
+  // Вызывается из рабочего потока, чтобы чтение с диска не попало в кадр
+  void Prefetch() const;
+
+  bool IsOpen() const { return data_ != nullptr; }
+  const uint8_t* GetData() const { return data_; }
+  size_t GetSize() const { return size_; }
+
+ private:
+  const uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+#ifdef _WIN32
+  void* file_ = nullptr;     // HANDLE файла
+  void* mapping_ = nullptr;  // HANDLE отображения
+#endif
+};
@@ -0,0 +1,107 @@
+#include "simulation_thread.h"
+#include <algorithm>
+
+// Максимальное отставание, которое поток пытается догнать за один проход
+constexpr float kMaxCatchUpTime = 0.25f;
+
+// Сколько снимков хранит поток отрисовки: двух может не хватить, если
+// новый снимок пришёл раньше, чем отрисовка дошла до предыдущего
+constexpr size_t kMaxHistory = 3;
+
+SimulationThread::SimulationThread(Scene& scene, float fixedDeltaTime)
+    : scene_(scene), fixedDeltaTime_(fixedDeltaTime) {
+  // Начальное состояние - текущая сцена
+  history_.emplace_back();
+  scene_.CaptureSnapshot(history_.back());
+  startTime_ = history_.back().time;
+  latestPublishedAt_ = Clock::now();
+}
+
+SimulationThread::~SimulationThread() {
+  Stop();
+}
+
+void SimulationThread::Start() {
+  if (running_) {
+    return;
+  }
+  running_ = true;
+  thread_ = std::thread(&SimulationThread::Run, this);
+}
+
+void SimulationThread::Stop() {
+  running_ = false;
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+void SimulationThread::Run() {
+  Clock::time_point lastTime = Clock::now();
+  float accumulator = 0.0f;
+  double simulationTime = startTime_;
+
+  while (running_) {
+    Clock::time_point now = Clock::now();
+    accumulator += std::chrono::duration<float>(now - lastTime).count();
+    accumulator = std::min(accumulator, kMaxCatchUpTime);
+    lastTime = now;
+
+    bool stepped = false;
+    while (accumulator >= fixedDeltaTime_) {
+      scene_.StepPhysics(fixedDeltaTime_);
+      simulationTime += fixedDeltaTime_;
+      accumulator -= fixedDeltaTime_;
+      stepped = true;
+    }
+
+    if (stepped) {
+      TimedSnapshot& out = snapshots_.WriteBuffer();
+      scene_.CaptureSnapshot(out.snapshot);
+      out.snapshot.time = simulationTime;
+      out.leftover = accumulator;
+      out.publishedAt = Clock::now();
+      snapshots_.Publish();
+    }
+
+    // Спим до следующего шага
+    std::this_thread::sleep_for(
+        std::chrono::duration<float>(fixedDeltaTime_ - accumulator));
+  }
+}
+
+void SimulationThread::SyncRenderState() {
+  if (snapshots_.Consume()) {
+    const TimedSnapshot& latest = snapshots_.ReadBuffer();
+    if (history_.size() == kMaxHistory) {
+      history_.pop_front();
+    }
+    history_.push_back(latest.snapshot);
+    latestLeftover_ = latest.leftover;
+    latestPublishedAt_ = latest.publishedAt;
+  }
+
+  // Модельное время сейчас: время последнего снимка, остаток аккумулятора
+  // и прошедшее с публикации (не дальше следующего шага). Отрисовка
+  // отстаёт от него на один шаг, чтобы было между чем интерполировать
+  float sincePublish =
+      std::chrono::duration<float>(Clock::now() - latestPublishedAt_).count();
+  sincePublish = std::clamp(sincePublish, 0.0f,
+                            std::max(fixedDeltaTime_ - latestLeftover_, 0.0f));
+  double renderTime = history_.back().time + latestLeftover_ + sincePublish -
+                      fixedDeltaTime_;
+
+  // Снимки могут быть на несколько шагов друг от друга, поэтому доля
+  // берётся по их модельному времени, а не по времени публикации
+  while (history_.size() > 2 && history_[1].time <= renderTime) {
+    history_.pop_front();
+  }
+  const PhysicsSnapshot& from = history_.front();
+  const PhysicsSnapshot& to = history_.size() > 1 ? history_[1] : from;
+  float alpha = 1.0f;
+  if (to.time > from.time) {
+    double t = (renderTime - from.time) / (to.time - from.time);
+    alpha = static_cast<float>(std::clamp(t, 0.0, 1.0));
+  }
+  scene_.ApplySnapshot(from, to, alpha);
+}
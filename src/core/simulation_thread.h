@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <thread>
+#include "physics/physics_snapshot.h"
+#include "render/scene.h"
+#include "triple_buffer.h"
+
+// Физика в отдельном потоке с фиксированным шагом.
+// После каждой серии шагов поток публикует снимок положений тел через
+// тройной буфер; поток отрисовки хранит последние снимки и интерполирует
+// по модельному времени между двумя, окружающими момент отрисовки, не
+// блокируя моделирование.
+// Пока поток запущен, сцену меняет только он (кроме графических объектов)
+class SimulationThread {
+ public:
+  SimulationThread(Scene& scene, float fixedDeltaTime);
+  ~SimulationThread();
+
+  SimulationThread(const SimulationThread&) = delete;
+  SimulationThread& operator=(const SimulationThread&) = delete;
+
+  void Start();
+  void Stop();
+
+  // Забирает новый снимок (если он есть) и выставляет графическим
+  // объектам интерполированные положения. Вызывается потоком отрисовки
+  void SyncRenderState();
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  void Run();
+
+  Scene& scene_;
+  float fixedDeltaTime_;
+  std::thread thread_;
+  std::atomic<bool> running_{false};
+
+  // Снимок вместе с остатком аккумулятора (модельное время, ещё не
+  // пройденное шагами) и моментом публикации
+  struct TimedSnapshot {
+    PhysicsSnapshot snapshot;
+    float leftover = 0.0f;
+    Clock::time_point publishedAt;
+  };
+
+  TripleBuffer<TimedSnapshot> snapshots_;
+  double startTime_ = 0.0;  // Модельное время до первого шага
+
+  // Данные потока отрисовки: последние снимки по возрастанию времени и
+  // параметры последней публикации
+  std::deque<PhysicsSnapshot> history_;
+  float latestLeftover_ = 0.0f;
+  Clock::time_point latestPublishedAt_;
+};
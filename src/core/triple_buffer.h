@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Тройной буфер без блокировок для одного писателя и одного читателя.
+// Писатель заполняет свой буфер и публикует его, обменивая с общим;
+// читатель забирает общий буфер, только если в нём есть новые данные.
+// Ни одна из сторон никогда не ждёт другую
+template <typename T>
+class TripleBuffer {
+ public:
+  // Буфер писателя для заполнения
+  T& WriteBuffer() { return buffers_[writeIndex_]; }
+
+  // Публикует заполненный буфер писателя
+  void Publish() {
+    uint8_t previous =
+        shared_.exchange(writeIndex_ | kFreshBit, std::memory_order_acq_rel);
+    writeIndex_ = previous & kIndexMask;
+  }
+
+  // Забирает последний опубликованный буфер. Возвращает false, если с
+  // прошлого вызова ничего нового не публиковалось
+  bool Consume() {
+    if ((shared_.load(std::memory_order_relaxed) & kFreshBit) == 0) {
+      return false;
+    }
+    uint8_t previous = shared_.exchange(readIndex_, std::memory_order_acq_rel);
+    readIndex_ = previous & kIndexMask;
+    return true;
+  }
+
+  // Буфер читателя (последний забранный)
+  const T& ReadBuffer() const { return buffers_[readIndex_]; }
+
+ private:
+  static constexpr uint8_t kIndexMask = 0x3;
+  static constexpr uint8_t kFreshBit = 0x4;
+
+  std::array<T, 3> buffers_;
+  std::atomic<uint8_t> shared_{1};  // Индекс общего буфера + флаг новизны
+  uint8_t writeIndex_ = 0;
+  uint8_t readIndex_ = 2;
+};
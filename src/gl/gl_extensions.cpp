@@ -0,0 +1,49 @@
+#include "gl_extensions.h"
+#include <SDL2/SDL.h>
+
+GLExtensions& GLExtensions::GetInstance() {
+  static GLExtensions instance;
+  return instance;
+}
+
+void GLExtensions::Load() {
+  names_.clear();
+  GLint count = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+  for (GLint i = 0; i < count; ++i) {
+    const GLubyte* name = glGetStringi(GL_EXTENSIONS, i);
+    if (name) {
+      names_.insert(reinterpret_cast<const char*>(name));
+    }
+  }
+
+  GLint major = 0;
+  GLint minor = 0;
+  glGetIntegerv(GL_MAJOR_VERSION, &major);
+  glGetIntegerv(GL_MINOR_VERSION, &minor);
+  bool gl41 = major > 4 || (major == 4 && minor >= 1);
+  bool gl44 = major > 4 || (major == 4 && minor >= 4);
+
+  if (gl44 || Has("GL_ARB_buffer_storage")) {
+    BufferStorage = reinterpret_cast<BufferStorageProc>(
+        SDL_GL_GetProcAddress("glBufferStorage"));
+    hasBufferStorage = BufferStorage != nullptr;
+  }
+
+  if (gl41 || Has("GL_ARB_get_program_binary")) {
+    GetProgramBinary = reinterpret_cast<GetProgramBinaryProc>(
+        SDL_GL_GetProcAddress("glGetProgramBinary"));
+    ProgramBinary = reinterpret_cast<ProgramBinaryProc>(
+        SDL_GL_GetProcAddress("glProgramBinary"));
+    ProgramParameteri = reinterpret_cast<ProgramParameteriProc>(
+        SDL_GL_GetProcAddress("glProgramParameteri"));
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    hasProgramBinary = GetProgramBinary && ProgramBinary &&
+                       ProgramParameteri && formats > 0;
+  }
+}
+
+bool GLExtensions::Has(const std::string& name) const {
+  return names_.contains(name);
+}
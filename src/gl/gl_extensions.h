@@ -0,0 +1,68 @@
+#pragma once
+#include <glad/glad.h>
+#include <string>
+#include <unordered_set>
+
+// Константы GL_ARB_buffer_storage (нет в заголовке glad для ядра 3.3)
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
+#define GL_CLIENT_STORAGE_BIT 0x0200
+#endif
+
+// Константы GL_ARB_get_program_binary
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#define GL_PROGRAM_BINARY_FORMATS 0x87FF
+#endif
+
+// Расширения OpenGL сверх ядра 3.3. glad загружает только ядро, поэтому
+// функции расширений получаем сами через SDL_GL_GetProcAddress.
+// Load() вызывается после инициализации glad в текущем контексте
+class GLExtensions {
+ public:
+  using BufferStorageProc = void(APIENTRYP)(GLenum target,
+                                            GLsizeiptr size,
+                                            const void* data,
+                                            GLbitfield flags);
+  using GetProgramBinaryProc = void(APIENTRYP)(GLuint program,
+                                               GLsizei bufSize,
+                                               GLsizei* length,
+                                               GLenum* binaryFormat,
+                                               void* binary);
+  using ProgramBinaryProc = void(APIENTRYP)(GLuint program,
+                                            GLenum binaryFormat,
+                                            const void* binary,
+                                            GLsizei length);
+  using ProgramParameteriProc = void(APIENTRYP)(GLuint program,
+                                                GLenum pname,
+                                                GLint value);
+
+  static GLExtensions& GetInstance();
+
+  void Load();
+
+  bool Has(const std::string& name) const;
+
+  // GL_ARB_buffer_storage (ядро GL 4.4)
+  bool hasBufferStorage = false;
+  BufferStorageProc BufferStorage = nullptr;
+
+  // GL_ARB_get_program_binary (ядро GL 4.1). Флаг сброшен и тогда, когда
+  // драйвер не поддерживает ни одного формата бинарника
+  bool hasProgramBinary = false;
+  GetProgramBinaryProc GetProgramBinary = nullptr;
+  ProgramBinaryProc ProgramBinary = nullptr;
+  ProgramParameteriProc ProgramParameteri = nullptr;
+
+ private:
+  GLExtensions() = default;
+
+  GLExtensions(const GLExtensions&) = delete;
+  GLExtensions& operator=(const GLExtensions&) = delete;
+
+  std::unordered_set<std::string> names_;
+};
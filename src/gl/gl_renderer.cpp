@@ -1,9 +1,13 @@
 #include "gl_renderer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <iostream>
-#include "render/app_utils.h"
-#include "render/material_converter.h"
+#include "gl_extensions.h"
 #include "render/scene_entity.h"
+#include "render/scene_object_box.h"
 #include "render/scene_object_sphere.h"
+#include "render/texture_manager.h"
 
 GLRenderer::GLRenderer(SDL_Window* window)
     : glContext_(nullptr), VAO_(0), VBO_(0), EBO_(0) {
@@ -16,9 +20,21 @@ GLRenderer::GLRenderer(SDL_Window* window)
 
 GLRenderer::~GLRenderer() {
   // === Очистка ресурсов ===
-  glDeleteVertexArrays(1, &VAO_);  // Удаление VAO
-  glDeleteBuffers(1, &VBO_);       // Удаление VBO
-  glDeleteBuffers(1, &EBO_);       // Удаление EBO
+  // Буферы удаляются, пока жив контекст
+  headerStream_.reset();
+  objectStream_.reset();
+  gridIndexStream_.reset();
+  sceneTarget_.reset();
+  glDeleteTextures(1, &objectTexture_);     // Текстура буфера объектов
+  glDeleteTextures(1, &gridCellTexture_);   // Ячейки сетки
+  glDeleteTextures(1, &gridIndexTexture_);  // Индексы сетки
+  glDeleteTextures(1, &staticTexture_);     // Статическая геометрия
+  glDeleteBuffers(1, &staticBuffer_);
+  glDeleteTextures(1, &materialTexture_);   // Таблица материалов
+  glDeleteBuffers(1, &materialBuffer_);
+  glDeleteVertexArrays(1, &VAO_);           // Удаление VAO
+  glDeleteBuffers(1, &VBO_);                // Удаление VBO
+  glDeleteBuffers(1, &EBO_);                // Удаление EBO
   if (glContext_) {
     SDL_GL_DeleteContext(glContext_);  // Удаление OpenGL-контекста
   }
@@ -37,19 +53,83 @@ bool GLRenderer::Initialize() {
 
   SetupQuad();
 
-  // === Создание UBO ===
-  glGenBuffers(1, &uboBalls_);
-  glBindBuffer(GL_UNIFORM_BUFFER, uboBalls_);
-  // Выделяем память
-  glBufferData(GL_UNIFORM_BUFFER, sizeof(UBOData), nullptr, GL_DYNAMIC_DRAW);
-  // Привязываем буфер к точке привязки (Binding Point) 0
-  glBindBufferBase(GL_UNIFORM_BUFFER, 0, uboBalls_);
-  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+  // Функции расширений, которых нет в glad
+  GLExtensions::GetInstance().Load();
+
+  // === Создание UBO и буфера объектов ===
+  headerStream_ =
+      std::make_unique<StreamBuffer>(GL_UNIFORM_BUFFER, sizeof(UBOData));
+  glGenTextures(1, &objectTexture_);
+  ReserveTextureBuffer(objectStream_, objectTexture_, GL_RGBA32F,
+                       sizeof(GPUObject));
+
+  // Текстура ячеек сетки: целочисленная, без фильтрации
+  glGenTextures(1, &gridCellTexture_);
+  glBindTexture(GL_TEXTURE_2D, gridCellTexture_);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glGenTextures(1, &gridIndexTexture_);
+  ReserveTextureBuffer(gridIndexStream_, gridIndexTexture_, GL_R32I,
+                       sizeof(int32_t));
+
+  // Буфер статической геометрии: заполняется при смене сцены
+  glGenBuffers(1, &staticBuffer_);
+  glGenTextures(1, &staticTexture_);
+  glBindTexture(GL_TEXTURE_BUFFER, staticTexture_);
+  glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, staticBuffer_);
+  glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+  // Таблица материалов: заполняется при смене сцены
+  glGenBuffers(1, &materialBuffer_);
+  glGenTextures(1, &materialTexture_);
+  glBindTexture(GL_TEXTURE_BUFFER, materialTexture_);
+  glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, materialBuffer_);
+  glBindTexture(GL_TEXTURE_BUFFER, 0);
 
   return true;
 }
 
-void GLRenderer::Render(const Shader& shader, const Texture& texture) {
+void GLRenderer::SetViewport(int width,
+                             int height,
+                             float renderScale,
+                             float maxRenderScale) {
+  outputWidth_ = std::max(width, 1);
+  outputHeight_ = std::max(height, 1);
+  maxRenderScale_ = std::clamp(maxRenderScale, 0.1f, 1.0f);
+  renderScale_ = std::clamp(renderScale, 0.1f, maxRenderScale_);
+}
+
+int GLRenderer::GetRenderWidth() const {
+  return std::max(static_cast<int>(outputWidth_ * renderScale_ + 0.5f), 1);
+}
+
+int GLRenderer::GetRenderHeight() const {
+  return std::max(static_cast<int>(outputHeight_ * renderScale_ + 0.5f), 1);
+}
+
+void GLRenderer::Render(const Shader& shader,
+                        const Texture& texture,
+                        const Shader* upsampleShader) {
+  // Пониженное разрешение: raymarch во внеэкранный буфер
+  bool scaled = upsampleShader && renderScale_ < 1.0f;
+  if (scaled) {
+    if (!sceneTarget_) {
+      sceneTarget_ = std::make_unique<RenderTarget>();
+    }
+    int capacityWidth = static_cast<int>(
+        std::ceil(outputWidth_ * maxRenderScale_));
+    int capacityHeight = static_cast<int>(
+        std::ceil(outputHeight_ * maxRenderScale_));
+    scaled = sceneTarget_->Resize(capacityWidth, capacityHeight);
+  }
+  if (scaled) {
+    sceneTarget_->Bind(GetRenderWidth(), GetRenderHeight());
+  } else {
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, outputWidth_, outputHeight_);
+  }
+
   // Очистка цветового буфера
   glClearColor(0.0f, 0.0f, 0.0f, 1.0f);  // Установка цвета очистки: чёрный
   glClear(GL_COLOR_BUFFER_BIT);          // Выполнение очистки
@@ -60,7 +140,34 @@ void GLRenderer::Render(const Shader& shader, const Texture& texture) {
   shader.setInt(
       "texture1",
       0);  // Установка uniform-переменной в шейдере: texture1 использует юнит 0
+  DrawQuad();
+
+  // === Увеличение до размера окна ===
+  if (scaled) {
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, outputWidth_, outputHeight_);
+    upsampleShader->use();
+    // Цвет на юните 0 (texture1 перепривязывается каждый кадр), данные
+    // попаданий - на своём юните, чтобы не трогать массив текстур
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, sceneTarget_->GetColorTexture());
+    glActiveTexture(GL_TEXTURE0 + kSceneDataUnit);
+    glBindTexture(GL_TEXTURE_2D, sceneTarget_->GetDataTexture());
+    upsampleShader->setInt("sceneColor", 0);
+    upsampleShader->setInt("sceneData", kSceneDataUnit);
+    upsampleShader->setVec2("sourceSize",
+                            static_cast<float>(GetRenderWidth()),
+                            static_cast<float>(GetRenderHeight()));
+    DrawQuad();
+  }
 
+  // Регионы этого кадра заняты, пока GPU не выполнит отрисовку
+  headerStream_->EndFrame();
+  objectStream_->EndFrame();
+  gridIndexStream_->EndFrame();
+}
+
+void GLRenderer::DrawQuad() {
   // Привязка VAO — восстанавливаем состояние вершинных данных
   glBindVertexArray(VAO_);
   glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT,
@@ -73,77 +180,206 @@ void GLRenderer::BindTexture(const Texture& texture) {
   texture.bindTexture();         // Привязка текстуры к активному юниту
 }
 
-void GLRenderer::UpdateUniforms(const Scene& scene, Shader& shader) {
-  shader.use();
-
-  // Связываем индекс блока в шейдере с точкой привязки 0
-  unsigned int blockIndex = glGetUniformBlockIndex(shader.getID(), "BallBlock");
-  glUniformBlockBinding(shader.getID(), blockIndex, 0);
-
-  // Подготовка данных на CPU
-  UBOData uboData;
-  // Обнуляем память, чтобы в паддингах не было мусора
-  std::memset(&uboData, 0, sizeof(UBOData));
-
-  uboData.ballCount = 0;
-  uboData.ballRadius = 0.0f;
+void GLRenderer::CacheScene(const Scene& scene) {
+  cachedScene_ = &scene;
+  cachedEntityCount_ = scene.GetEntities().size();
+  objects_.clear();
+  materials_.Clear();
+  std::vector<CachedObject> staticObjects;
 
-  const auto& entities = scene.GetEntities();
-  for (const auto& entity : entities) {
+  for (const auto& entity : scene.GetEntities()) {
     if (!entity->object) {
       continue;
     }
 
-    if (auto* sphere = dynamic_cast<Sphere*>(entity->object.get())) {
-      if (uboData.ballCount >= 16) {  // Лимит массива в шейдере
-        break;
-      }
-
-      int i = uboData.ballCount;
-
-      if (uboData.ballRadius == 0.0f) {
-        uboData.ballRadius = sphere->GetRadius();
-      }
-
-      // Копирование позиции
-      vec3 pos = sphere->GetRenderPosition();
-      uboData.balls[i].px = pos[0];
-      uboData.balls[i].py = pos[1];
-      uboData.balls[i].pz = pos[2];
-
-      // Копирование матрицы вращения (Конвертация quat -> mat3 -> 3x vec4)
-      quat q = (entity->body) ? entity->body->orientation : quat(1, 0, 0, 0);
-      mat3<float> R = quatToMat3(q);
-      // Столбец 0
-      uboData.balls[i].rotCol0[0] = R[0][0];
-      uboData.balls[i].rotCol0[1] = R[1][0];
-      uboData.balls[i].rotCol0[2] = R[2][0];
-      // Столбец 1
-      uboData.balls[i].rotCol1[0] = R[0][1];
-      uboData.balls[i].rotCol1[1] = R[1][1];
-      uboData.balls[i].rotCol1[2] = R[2][1];
-      // Столбец 2
-      uboData.balls[i].rotCol2[0] = R[0][2];
-      uboData.balls[i].rotCol2[1] = R[1][2];
-      uboData.balls[i].rotCol2[2] = R[2][2];
-
-      // Конвертация материала
-      const Material& mat = sphere->GetMaterial();
-      const MaterialPBR* pbrMat = dynamic_cast<const MaterialPBR*>(&mat);
-      uboData.balls[i].material = MaterialConverter::Convert(pbrMat, i);
-
-      uboData.ballCount++;
+    CachedObject cached;
+    cached.object = entity->object.get();
+    bool isStatic = false;
+    if (auto* sphere = dynamic_cast<const Sphere*>(cached.object)) {
+      cached.type = kGPUObjectSphere;
+      cached.size = vec3(sphere->GetRadius(), 0.0f, 0.0f);
+    } else if (auto* box = dynamic_cast<const Box*>(cached.object)) {
+      cached.type = kGPUObjectBox;
+      cached.size = box->GetHalfExtents();
+      // Неподвижные коробки (стол, борта) не меняются между кадрами
+      isStatic = !entity->body || entity->body->isStatic;
+    } else {
+      continue;
     }
+
+    // Материал конвертируется один раз, объект хранит лишь его индекс
+    cached.material = materials_.Register(cached.object->GetMaterial());
+    (isStatic ? staticObjects : objects_).push_back(cached);
+  }
+  materials_.ReleaseRetiredLayers();
+
+  // Статическая геометрия загружается один раз на сцену
+  std::vector<GPUObject> staticData(staticObjects.size());
+  for (size_t i = 0; i < staticObjects.size(); ++i) {
+    WriteObject(staticObjects[i], staticData[i]);
+  }
+  glBindBuffer(GL_TEXTURE_BUFFER, staticBuffer_);
+  glBufferData(GL_TEXTURE_BUFFER,
+               std::max<size_t>(staticData.size(), 1) * sizeof(GPUObject),
+               staticData.data(), GL_STATIC_DRAW);
+  glBindBuffer(GL_TEXTURE_BUFFER, 0);
+  staticCount_ = static_cast<int>(staticData.size());
+
+  // Таблица материалов - тоже один раз на сцену
+  const auto& materials = materials_.GetMaterials();
+  glBindBuffer(GL_TEXTURE_BUFFER, materialBuffer_);
+  glBufferData(GL_TEXTURE_BUFFER,
+               std::max<size_t>(materials.size(), 1) * sizeof(GPUMaterial),
+               materials.data(), GL_STATIC_DRAW);
+  glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void GLRenderer::WriteObject(const CachedObject& cached, GPUObject& gpuObject) {
+  // Копирование позиции, типа и размера
+  vec3 pos = cached.object->GetRenderPosition();
+  gpuObject.px = pos[0];
+  gpuObject.py = pos[1];
+  gpuObject.pz = pos[2];
+  gpuObject.type = static_cast<float>(cached.type);
+  gpuObject.sx = cached.size[0];
+  gpuObject.sy = cached.size[1];
+  gpuObject.sz = cached.size[2];
+  gpuObject.material = static_cast<float>(cached.material);
+
+  // Копирование матрицы вращения (Конвертация quat -> mat3 -> 3x vec4)
+  mat3<float> R = quatToMat3(cached.object->GetRenderOrientation());
+  // Столбец 0
+  gpuObject.rotCol0[0] = R[0][0];
+  gpuObject.rotCol0[1] = R[1][0];
+  gpuObject.rotCol0[2] = R[2][0];
+  // Столбец 1
+  gpuObject.rotCol1[0] = R[0][1];
+  gpuObject.rotCol1[1] = R[1][1];
+  gpuObject.rotCol1[2] = R[2][1];
+  // Столбец 2
+  gpuObject.rotCol2[0] = R[0][2];
+  gpuObject.rotCol2[1] = R[1][2];
+  gpuObject.rotCol2[2] = R[2][2];
+}
+
+void GLRenderer::ReserveTextureBuffer(std::unique_ptr<StreamBuffer>& stream,
+                                      GLuint texture,
+                                      GLenum format,
+                                      size_t bytes) {
+  if (stream && stream->GetRegionSize() >= bytes) {
+    return;
+  }
+
+  // Запас, чтобы не пересоздавать буфер при каждом новом объекте
+  size_t capacity = std::max<size_t>(bytes * 2, 4096);
+  stream = std::make_unique<StreamBuffer>(GL_TEXTURE_BUFFER, capacity);
+
+  glBindTexture(GL_TEXTURE_BUFFER, texture);
+  glTexBuffer(GL_TEXTURE_BUFFER, format, stream->GetBuffer());
+  glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+void GLRenderer::UpdateGrid(UBOData& header) {
+  // Описанные круги объектов на плоскости стола
+  gridItems_.resize(objects_.size());
+  for (size_t i = 0; i < objects_.size(); ++i) {
+    const CachedObject& cached = objects_[i];
+    vec3 pos = cached.object->GetRenderPosition();
+    float extent = (cached.type == kGPUObjectSphere) ? cached.size[0]
+                                                      : length(cached.size);
+    gridItems_[i] = {pos[0], pos[1], extent};
+  }
+  grid_.Build(gridItems_);
+
+  header.gridMinX = grid_.GetMinX();
+  header.gridMinY = grid_.GetMinY();
+  header.gridCellSize = grid_.GetCellSize();
+  header.gridMargin = grid_.GetMargin();
+  header.gridWidth = grid_.GetWidth();
+  header.gridHeight = grid_.GetHeight();
+  header.gridIndexBase = 0;
+  if (grid_.GetWidth() == 0) {
+    return;
+  }
+
+  // Ячейки: пары (начало, количество) в текстуре RG32I
+  glActiveTexture(GL_TEXTURE0 + kGridCellsUnit);
+  glBindTexture(GL_TEXTURE_2D, gridCellTexture_);
+  if (grid_.GetWidth() != gridCellWidth_ ||
+      grid_.GetHeight() != gridCellHeight_) {
+    gridCellWidth_ = grid_.GetWidth();
+    gridCellHeight_ = grid_.GetHeight();
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RG32I, gridCellWidth_, gridCellHeight_,
+                 0, GL_RG_INTEGER, GL_INT, grid_.GetCells().data());
+  } else {
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, gridCellWidth_, gridCellHeight_,
+                    GL_RG_INTEGER, GL_INT, grid_.GetCells().data());
+  }
+
+  // Индексы объектов ячеек
+  const auto& indices = grid_.GetIndices();
+  size_t bytes = indices.size() * sizeof(int32_t);
+  ReserveTextureBuffer(gridIndexStream_, gridIndexTexture_, GL_R32I, bytes);
+  void* gridIndices = gridIndexStream_->BeginWrite();
+  if (!gridIndices) {
+    // Без индексов ячеек сетка в этом кадре отключается: sceneSDF
+    // перебирает все objectCount объектов (медленнее, но без пропусков)
+    header.gridWidth = header.gridHeight = 0;
+    return;
+  }
+  std::memcpy(gridIndices, indices.data(), bytes);
+  gridIndexStream_->EndWrite(bytes, 0);
+  header.gridIndexBase =
+      static_cast<int>(gridIndexStream_->GetOffset() / sizeof(int32_t));
+
+  glActiveTexture(GL_TEXTURE0 + kGridIndicesUnit);
+  glBindTexture(GL_TEXTURE_BUFFER, gridIndexTexture_);
+}
+
+void GLRenderer::UpdateUniforms(const Scene& scene) {
+  if (&scene != cachedScene_ ||
+      scene.GetEntities().size() != cachedEntityCount_) {
+    CacheScene(scene);
+  }
+  ReserveTextureBuffer(objectStream_, objectTexture_, GL_RGBA32F,
+                       objects_.size() * sizeof(GPUObject));
+
+  glActiveTexture(GL_TEXTURE0 + kObjectBufferUnit);
+  glBindTexture(GL_TEXTURE_BUFFER, objectTexture_);
+  glActiveTexture(GL_TEXTURE0 + kStaticBufferUnit);
+  glBindTexture(GL_TEXTURE_BUFFER, staticTexture_);
+  glActiveTexture(GL_TEXTURE0 + kMaterialBufferUnit);
+  glBindTexture(GL_TEXTURE_BUFFER, materialTexture_);
+  // Массив пересоздаётся, когда догружаются новые текстуры
+  glActiveTexture(GL_TEXTURE0 + kMaterialTextureUnit);
+  TextureManager::GetInstance().GetTextureArray().Bind();
+
+  // Запись прямо в память буфера: паддинги не читаются шейдером, поэтому
+  // обнулять данные не нужно
+  // Если буфер не удалось получить, в этом кадре остаются данные
+  // прошлого
+  auto* gpuObjects = static_cast<GPUObject*>(objectStream_->BeginWrite());
+  if (!gpuObjects) {
+    return;
+  }
+  for (size_t i = 0; i < objects_.size(); ++i) {
+    WriteObject(objects_[i], gpuObjects[i]);
   }
+  objectStream_->EndWrite(objects_.size() * sizeof(GPUObject), 0);
 
-  if (uboData.ballRadius == 0.0f) {
-    uboData.ballRadius = 1.35f;
+  // Заголовок: число объектов, начало региона этого кадра в текселях,
+  // число статических коробок и параметры сетки
+  auto* uboData = static_cast<UBOData*>(headerStream_->BeginWrite());
+  if (!uboData) {
+    return;
   }
+  uboData->objectCount = static_cast<int>(objects_.size());
+  uboData->objectBase = static_cast<int>(objectStream_->GetOffset() / 16);
+  uboData->staticCount = staticCount_;
+  UpdateGrid(*uboData);
 
   // === Отправка данных в GPU ===
-  glBindBuffer(GL_UNIFORM_BUFFER, uboBalls_);
-  glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(UBOData), &uboData);
-  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+  headerStream_->EndWrite(sizeof(UBOData), kObjectBlockBinding);
 }
 
 void GLRenderer::SetupQuad() {
@@ -1,25 +1,112 @@
 #pragma once
 #include <SDL2/SDL.h>
 #include <glad/glad.h>
+#include <memory>
+#include <vector>
+#include "render/gpu_data.h"
+#include "render/material_registry.h"
+#include "render/object_grid.h"
 #include "render/scene.h"
 #include "render/scene_object_sphere.h"
 #include "render/texture.h"
 #include "shader.h"
+#include "render_target.h"
+#include "stream_buffer.h"
 
 class GLRenderer {
  public:
+  // Точка привязки блока ObjectBlock
+  static constexpr GLuint kObjectBlockBinding = 0;
+
   GLRenderer(SDL_Window* window);
   ~GLRenderer();
 
   bool Initialize();
-  void Render(const Shader& shader, const Texture& texture);
-  void UpdateUniforms(const Scene& scene, Shader& shader);
+
+  // Размер окна и доля разрешения, в которой идёт raymarch-проход.
+  // Внеэкранный буфер выделяется под maxRenderScale, так что масштаб
+  // можно менять каждый кадр без пересоздания текстур
+  void SetViewport(int width,
+                   int height,
+                   float renderScale,
+                   float maxRenderScale = 1.0f);
+  int GetRenderWidth() const;
+  int GetRenderHeight() const;
+
+  // При renderScale < 1 сцена рисуется во внеэкранный буфер и
+  // увеличивается до размера окна шейдером upsampleShader
+  void Render(const Shader& shader,
+              const Texture& texture,
+              const Shader* upsampleShader = nullptr);
+  void UpdateUniforms(const Scene& scene);
+
+  // Число неподвижных коробок в статическом буфере текущей сцены
+  int GetStaticCount() const { return staticCount_; }
 
  private:
+  // Объект сцены с заранее найденным материалом
+  struct CachedObject {
+    const SceneObject* object = nullptr;
+    int type = kGPUObjectSphere;
+    vec3 size{0.0f};   // Радиус сферы (x) или полуразмеры коробки
+    int material = 0;  // Индекс в таблице материалов
+  };
+
   SDL_GLContext glContext_;
   GLuint VAO_, VBO_, EBO_;
-  GLuint uboBalls_;
+
+  // Размер окна и кадр raymarch-прохода в пониженном разрешении
+  int outputWidth_ = 800;
+  int outputHeight_ = 600;
+  float renderScale_ = 1.0f;
+  float maxRenderScale_ = 1.0f;
+  std::unique_ptr<RenderTarget> sceneTarget_;
+
+  // Данные кадра: заголовок в UBO и объекты в texture buffer.
+  // Оба буфера - кольца регионов, CPU пишет кадр, пока GPU читает прошлые
+  std::unique_ptr<StreamBuffer> headerStream_;
+  std::unique_ptr<StreamBuffer> objectStream_;
+  GLuint objectTexture_ = 0;  // Текстура-представление буфера объектов
+
+  // Неподвижные коробки сцены: загружаются один раз в CacheScene и
+  // больше не пересылаются
+  GLuint staticBuffer_ = 0;
+  GLuint staticTexture_ = 0;
+  int staticCount_ = 0;
+
+  // Таблица материалов сцены в texture buffer, тоже загружается один раз
+  MaterialRegistry materials_;
+  GLuint materialBuffer_ = 0;
+  GLuint materialTexture_ = 0;
+
+  // Сетка объектов: ячейки в целочисленной 2D-текстуре, индексы в TBO
+  ObjectGrid grid_;
+  std::vector<ObjectGrid::Item> gridItems_;
+  std::unique_ptr<StreamBuffer> gridIndexStream_;
+  GLuint gridIndexTexture_ = 0;
+  GLuint gridCellTexture_ = 0;
+  int gridCellWidth_ = 0;  // Размер выделенной текстуры ячеек
+  int gridCellHeight_ = 0;
+
+  // Список объектов строится один раз на сцену
+  const Scene* cachedScene_ = nullptr;
+  size_t cachedEntityCount_ = 0;
+  std::vector<CachedObject> objects_;
 
   void SetupQuad();
+  void DrawQuad();
   void BindTexture(const Texture& texture);
+  void CacheScene(const Scene& scene);
+
+  // Заполняет запись буфера объектов по текущему состоянию объекта
+  static void WriteObject(const CachedObject& cached, GPUObject& gpuObject);
+
+  // Пересоздаёт кольцевой texture buffer, если кадр в него не помещается
+  void ReserveTextureBuffer(std::unique_ptr<StreamBuffer>& stream,
+                            GLuint texture,
+                            GLenum format,
+                            size_t bytes);
+
+  // Строит сетку по объектам кадра и загружает её в GPU
+  void UpdateGrid(UBOData& header);
 };
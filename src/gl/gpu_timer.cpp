@@ -0,0 +1,46 @@
+#include "gpu_timer.h"
+
+GpuTimer::GpuTimer(int latency) : queries_(latency > 0 ? latency : 1) {
+  glGenQueries(static_cast<GLsizei>(queries_.size()), queries_.data());
+}
+
+GpuTimer::~GpuTimer() {
+  glDeleteQueries(static_cast<GLsizei>(queries_.size()), queries_.data());
+}
+
+void GpuTimer::Begin() {
+  active_ = pending_ < static_cast<int>(queries_.size());
+  if (active_) {
+    glBeginQuery(GL_TIME_ELAPSED, queries_[next_]);
+  }
+}
+
+void GpuTimer::End() {
+  if (!active_) {
+    return;
+  }
+  glEndQuery(GL_TIME_ELAPSED);
+  active_ = false;
+  next_ = (next_ + 1) % static_cast<int>(queries_.size());
+  ++pending_;
+}
+
+bool GpuTimer::Poll(double& milliseconds) {
+  int count = static_cast<int>(queries_.size());
+  bool found = false;
+  // Результаты приходят по порядку: проверяем с самого старого запроса
+  while (pending_ > 0) {
+    GLuint query = queries_[(next_ - pending_ + count) % count];
+    GLint available = GL_FALSE;
+    glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+      break;
+    }
+    GLuint64 nanoseconds = 0;
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+    milliseconds = static_cast<double>(nanoseconds) * 1e-6;
+    found = true;
+    --pending_;
+  }
+  return found;
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <glad/glad.h>
+#include <vector>
+
+// Замер времени GPU запросами GL_TIME_ELAPSED. Запросы идут по кольцу,
+// а результат забирается через несколько кадров, когда он уже готов,
+// поэтому CPU никогда не ждёт GPU
+class GpuTimer {
+ public:
+  // latency - число кадров, которые могут быть в полёте одновременно
+  explicit GpuTimer(int latency = 4);
+  ~GpuTimer();
+
+  GpuTimer(const GpuTimer&) = delete;
+  GpuTimer& operator=(const GpuTimer&) = delete;
+
+  // Обрамляют команды кадра. Если все запросы ещё в полёте, кадр
+  // пропускается
+  void Begin();
+  void End();
+
+  // Забирает готовые результаты, не блокируя. Возвращает true и время
+  // самого свежего из них в миллисекундах
+  bool Poll(double& milliseconds);
+
+ private:
+  std::vector<GLuint> queries_;
+  int next_ = 0;     // Запрос для следующего Begin()
+  int pending_ = 0;  // Отправленные, но ещё не прочитанные запросы
+  bool active_ = false;
+};
@@ -0,0 +1,75 @@
+#include "render_target.h"
+#include <algorithm>
+#include <iostream>
+
+// Текстура-вложение без фильтрации: проход увеличения читает тексели сам
+static GLuint CreateAttachment(GLint internalFormat,
+                               GLenum format,
+                               GLenum type,
+                               int width,
+                               int height) {
+  GLuint texture = 0;
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format,
+               type, nullptr);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  return texture;
+}
+
+RenderTarget::~RenderTarget() {
+  Release();
+}
+
+bool RenderTarget::Resize(int width, int height) {
+  if (framebuffer_ != 0 && width == width_ && height == height_) {
+    return true;
+  }
+  Release();
+  width_ = width;
+  height_ = height;
+
+  colorTexture_ =
+      CreateAttachment(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, width, height);
+  dataTexture_ = CreateAttachment(GL_RG32F, GL_RG, GL_FLOAT, width, height);
+
+  glGenFramebuffers(1, &framebuffer_);
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                         colorTexture_, 0);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D,
+                         dataTexture_, 0);
+  const GLenum drawBuffers[] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+  glDrawBuffers(2, drawBuffers);
+
+  GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  if (status != GL_FRAMEBUFFER_COMPLETE) {
+    std::cerr << "Render target " << width << "x" << height
+              << " is incomplete: 0x" << std::hex << status << std::dec
+              << std::endl;
+    Release();
+    return false;
+  }
+  return true;
+}
+
+void RenderTarget::Bind(int width, int height) const {
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+  glViewport(0, 0, std::min(width, width_), std::min(height, height_));
+}
+
+void RenderTarget::Release() {
+  glDeleteFramebuffers(1, &framebuffer_);
+  glDeleteTextures(1, &colorTexture_);
+  glDeleteTextures(1, &dataTexture_);
+  framebuffer_ = 0;
+  colorTexture_ = 0;
+  dataTexture_ = 0;
+  width_ = 0;
+  height_ = 0;
+}
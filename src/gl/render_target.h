@@ -0,0 +1,37 @@
+#pragma once
+#include <glad/glad.h>
+
+// Внеэкранный буфер кадра для raymarch-прохода: цвет и данные первого
+// попадания (расстояние вдоль луча и идентификатор объекта), по которым
+// проход увеличения сохраняет границы объектов. Вложения выделяются под
+// наибольшее разрешение, а кадр занимает их левый нижний угол, поэтому
+// смена разрешения не пересоздаёт текстуры
+class RenderTarget {
+ public:
+  RenderTarget() = default;
+  ~RenderTarget();
+
+  RenderTarget(const RenderTarget&) = delete;
+  RenderTarget& operator=(const RenderTarget&) = delete;
+
+  // Пересоздаёт вложения, если размер изменился. Возвращает false, если
+  // буфер кадра неполон
+  bool Resize(int width, int height);
+
+  // Делает буфер текущим и выставляет viewport на угол width x height
+  void Bind(int width, int height) const;
+
+  GLuint GetColorTexture() const { return colorTexture_; }
+  GLuint GetDataTexture() const { return dataTexture_; }
+  int GetWidth() const { return width_; }
+  int GetHeight() const { return height_; }
+
+ private:
+  void Release();
+
+  GLuint framebuffer_ = 0;
+  GLuint colorTexture_ = 0;  // RGBA8: цвет
+  GLuint dataTexture_ = 0;   // RG32F: расстояние и идентификатор
+  int width_ = 0;
+  int height_ = 0;
+};
@@ -2,8 +2,12 @@
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include "gl_extensions.h"
+#include "shader_cache.h"
 
-Shader::Shader(const std::string& vertexPath, const std::string& fragmentPath) {
+Shader::Shader(const std::string& vertexPath,
+               const std::string& fragmentPath,
+               const std::string& defines) {
   // Чтение шейдеров
   std::string vertexCode = readFile(vertexPath);
   if (vertexCode.empty()) {
@@ -20,6 +24,22 @@ Shader::Shader(const std::string& vertexPath, const std::string& fragmentPath) {
     return;
   }
 
+  if (!defines.empty()) {
+    vertexCode = injectDefines(vertexCode, defines);
+    fragmentCode = injectDefines(fragmentCode, defines);
+  }
+
+  // Готовый бинарник из кэша: компиляция текста не нужна
+  ShaderCache& cache = ShaderCache::GetInstance();
+  std::string cacheKey;
+  if (cache.IsEnabled()) {
+    cacheKey = cache.MakeKey(vertexCode, fragmentCode);
+    programID = cache.Load(cacheKey);
+    if (programID != 0) {
+      return;
+    }
+  }
+
   // Компиляция шейдеров
   GLuint vertexShader = compileShader(vertexCode, GL_VERTEX_SHADER);
   if (vertexShader == 0) {
@@ -37,6 +57,11 @@ Shader::Shader(const std::string& vertexPath, const std::string& fragmentPath) {
   programID = glCreateProgram();
   glAttachShader(programID, vertexShader);
   glAttachShader(programID, fragmentShader);
+  if (!cacheKey.empty()) {
+    // Просим драйвер сохранить бинарник, пригодный для кэша
+    GLExtensions::GetInstance().ProgramParameteri(
+        programID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+  }
   glLinkProgram(programID);
 
   // Проверка ошибок линковки
@@ -48,6 +73,8 @@ Shader::Shader(const std::string& vertexPath, const std::string& fragmentPath) {
     std::cerr << "Shader program linking failed:\n" << infoLog << std::endl;
     glDeleteProgram(programID);
     programID = 0;
+  } else if (!cacheKey.empty()) {
+    cache.Store(cacheKey, programID);
   }
 
   // Удаление шейдеров
@@ -97,6 +124,17 @@ void Shader::setMat3(const std::string& name, const float* mat_data) const {
   glUniformMatrix3fv(getUniformLocation(name), 1, GL_TRUE, mat_data);
 }
 
+void Shader::bindUniformBlock(const std::string& blockName,
+                              GLuint binding) const {
+  GLuint blockIndex = glGetUniformBlockIndex(programID, blockName.c_str());
+  if (blockIndex == GL_INVALID_INDEX) {
+    std::cerr << "Warning: uniform block '" << blockName << "' not found"
+              << std::endl;
+    return;
+  }
+  glUniformBlockBinding(programID, blockIndex, binding);
+}
+
 std::string Shader::readFile(const std::string& path) {
   std::ifstream file(path);
   if (!file.is_open()) {
@@ -108,6 +146,20 @@ std::string Shader::readFile(const std::string& path) {
   return buffer.str();
 }
 
+std::string Shader::injectDefines(const std::string& source,
+                                  const std::string& defines) {
+  // #version обязан быть первой директивой, поэтому вставляем после него
+  size_t versionPos = source.find("#version");
+  if (versionPos == std::string::npos) {
+    return defines + source;
+  }
+  size_t lineEnd = source.find('\n', versionPos);
+  if (lineEnd == std::string::npos) {
+    return source + "\n" + defines;
+  }
+  return source.substr(0, lineEnd + 1) + defines + source.substr(lineEnd + 1);
+}
+
 GLuint Shader::compileShader(const std::string& source, GLenum type) {
   if (source.empty()) {
     std::cerr << "Error: Shader source is empty for "
@@ -6,7 +6,10 @@
 
 class Shader {
  public:
-  Shader(const std::string& vertexPath, const std::string& fragmentPath);
+  // defines вставляются в оба шейдера сразу после строки #version
+  Shader(const std::string& vertexPath,
+         const std::string& fragmentPath,
+         const std::string& defines = "");
   ~Shader();
 
   void use() const;
@@ -18,6 +21,9 @@ class Shader {
   void setVec3(const std::string& name, const vec3& value) const;
   void setMat3(const std::string& name, const float* mat_data) const;
 
+  // Связывает uniform-блок с точкой привязки (один раз после линковки)
+  void bindUniformBlock(const std::string& blockName, GLuint binding) const;
+
   GLuint getID() const { return programID; }
 
  private:
@@ -25,6 +31,8 @@ class Shader {
   mutable std::unordered_map<std::string, GLint> uniformLocationCache;
 
   std::string readFile(const std::string& path);
+  static std::string injectDefines(const std::string& source,
+                                   const std::string& defines);
   GLuint compileShader(const std::string& source, GLenum type);
   GLint getUniformLocation(const std::string& name) const;
 };
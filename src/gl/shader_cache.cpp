@@ -0,0 +1,173 @@
+#include "shader_cache.h"
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include "gl_extensions.h"
+
+namespace {
+
+// Заголовок файла бинарника
+struct BinaryHeader {
+  char magic[4];       // "ESPB"
+  uint32_t format;     // Формат бинарника драйвера
+  uint32_t size;       // Размер данных после ключа
+  uint32_t keyLength;  // Длина ключа, записанного следом
+};
+
+constexpr char kMagic[4] = {'E', 'S', 'P', 'B'};
+
+// FNV-1a, 64 бита
+uint64_t HashString(uint64_t hash, const std::string& text) {
+  for (unsigned char c : text) {
+    hash ^= c;
+    hash *= 1099511628211ull;
+  }
+  // Разделитель, чтобы "ab"+"c" и "a"+"bc" давали разные ключи
+  hash ^= 0xff;
+  hash *= 1099511628211ull;
+  return hash;
+}
+
+std::string GetGLString(GLenum name) {
+  const GLubyte* value = glGetString(name);
+  return value ? reinterpret_cast<const char*>(value) : "";
+}
+
+}  // namespace
+
+ShaderCache& ShaderCache::GetInstance() {
+  static ShaderCache instance;
+  return instance;
+}
+
+void ShaderCache::SetDirectory(const std::string& directory) {
+  directory_ = directory;
+}
+
+bool ShaderCache::IsEnabled() const {
+  return !directory_.empty() && GLExtensions::GetInstance().hasProgramBinary;
+}
+
+std::string ShaderCache::MakeKey(const std::string& vertexCode,
+                                 const std::string& fragmentCode) const {
+  uint64_t hash = 14695981039346656037ull;
+  hash = HashString(hash, GetGLString(GL_VENDOR));
+  hash = HashString(hash, GetGLString(GL_RENDERER));
+  hash = HashString(hash, GetGLString(GL_VERSION));
+  hash = HashString(hash, vertexCode);
+  hash = HashString(hash, fragmentCode);
+
+  static const char kDigits[] = "0123456789abcdef";
+  std::string key(16, '0');
+  for (int i = 15; i >= 0; --i) {
+    key[i] = kDigits[hash & 0xf];
+    hash >>= 4;
+  }
+  return key;
+}
+
+std::string ShaderCache::PathFor(const std::string& key) const {
+  return (std::filesystem::path(directory_) / (key + ".bin")).string();
+}
+
+GLuint ShaderCache::Load(const std::string& key) const {
+  if (!IsEnabled()) {
+    return 0;
+  }
+  std::string path = PathFor(key);
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return 0;
+  }
+
+  // Длины из заголовка сверяются с размером файла до выделения памяти:
+  // обрезанный или испорченный файл - промах кэша
+  std::error_code sizeError;
+  uintmax_t fileSize = std::filesystem::file_size(path, sizeError);
+  BinaryHeader header{};
+  std::string storedKey;
+  std::vector<char> binary;
+  if (!sizeError &&
+      file.read(reinterpret_cast<char*>(&header), sizeof(header)) &&
+      std::equal(kMagic, kMagic + 4, header.magic) &&
+      header.keyLength == key.size() && header.size > 0 &&
+      fileSize == sizeof(header) + uintmax_t{header.keyLength} + header.size) {
+    storedKey.resize(header.keyLength);
+    binary.resize(header.size);
+    if (!file.read(storedKey.data(), header.keyLength) ||
+        !file.read(binary.data(), header.size)) {
+      storedKey.clear();
+      binary.clear();
+    }
+  }
+  file.close();
+
+  GLuint program = 0;
+  if (storedKey == key && !binary.empty()) {
+    program = glCreateProgram();
+    GLExtensions::GetInstance().ProgramBinary(
+        program, header.format, binary.data(),
+        static_cast<GLsizei>(binary.size()));
+    GLint success = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+      glDeleteProgram(program);
+      program = 0;
+    }
+  }
+
+  // Повреждённый или отвергнутый драйвером бинарник больше не нужен
+  if (program == 0) {
+    std::error_code error;
+    std::filesystem::remove(path, error);
+  }
+  return program;
+}
+
+void ShaderCache::Store(const std::string& key, GLuint program) const {
+  if (!IsEnabled() || program == 0) {
+    return;
+  }
+  GLint length = 0;
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0) {
+    return;
+  }
+
+  std::vector<char> binary(length);
+  GLenum format = 0;
+  GLsizei written = 0;
+  GLExtensions::GetInstance().GetProgramBinary(program, length, &written,
+                                               &format, binary.data());
+  if (written <= 0) {
+    return;
+  }
+
+  std::error_code error;
+  std::filesystem::create_directories(directory_, error);
+
+  // Пишем во временный файл и переименовываем, чтобы параллельный запуск
+  // не прочитал недописанный бинарник
+  std::string path = PathFor(key);
+  std::string tempPath = path + ".tmp";
+  {
+    std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+    if (!file) {
+      std::cerr << "Warning: cannot write shader cache " << tempPath
+                << std::endl;
+      return;
+    }
+    BinaryHeader header{};
+    std::copy(kMagic, kMagic + 4, header.magic);
+    header.format = format;
+    header.size = static_cast<uint32_t>(written);
+    header.keyLength = static_cast<uint32_t>(key.size());
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(key.data(), key.size());
+    file.write(binary.data(), written);
+  }
+  std::filesystem::rename(tempPath, path, error);
+}
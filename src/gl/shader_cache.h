@@ -0,0 +1,38 @@
+#pragma once
+#include <glad/glad.h>
+#include <string>
+
+// Дисковый кэш бинарников шейдерных программ. Ключ - хэш исходников
+// (вместе со вставленными #define) и строк драйвера, поэтому после
+// обновления драйвера или правки шейдера программа просто собирается
+// заново. Работает только при наличии GL_ARB_get_program_binary
+class ShaderCache {
+ public:
+  static ShaderCache& GetInstance();
+
+  // Каталог кэша; пустая строка выключает кэш
+  void SetDirectory(const std::string& directory);
+
+  bool IsEnabled() const;
+
+  // Ключ программы для пары исходников в текущем контексте
+  std::string MakeKey(const std::string& vertexCode,
+                      const std::string& fragmentCode) const;
+
+  // Загружает программу из кэша. Возвращает 0, если бинарника нет, файл
+  // повреждён или драйвер его отверг (такой файл удаляется)
+  GLuint Load(const std::string& key) const;
+
+  // Сохраняет бинарник слинкованной программы
+  void Store(const std::string& key, GLuint program) const;
+
+ private:
+  ShaderCache() = default;
+
+  ShaderCache(const ShaderCache&) = delete;
+  ShaderCache& operator=(const ShaderCache&) = delete;
+
+  std::string PathFor(const std::string& key) const;
+
+  std::string directory_ = "shader_cache";
+};
@@ -0,0 +1,110 @@
+#include "shader_permutations.h"
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+// Лимиты трассировки для уровня качества
+struct QualityLimits {
+  int maxBounces;    // Глубина отражений
+  int maxStepCount;  // Шаги маршинга на луч
+  int shadowSteps;   // Шаги луча тени
+  const char* name;
+};
+
+QualityLimits GetLimits(ShaderQuality quality) {
+  switch (quality) {
+    case ShaderQuality::Low:
+      return {2, 96, 16, "low"};
+    case ShaderQuality::Medium:
+      return {3, 128, 24, "medium"};
+    case ShaderQuality::High:
+      break;
+  }
+  return {4, 160, 32, "high"};
+}
+
+}  // namespace
+
+ShaderQuality ParseShaderQuality(const std::string& name) {
+  if (name == "low") {
+    return ShaderQuality::Low;
+  }
+  if (name == "medium") {
+    return ShaderQuality::Medium;
+  }
+  if (name == "high") {
+    return ShaderQuality::High;
+  }
+  throw std::runtime_error("Unknown shader quality: " + name);
+}
+
+ShaderVariant ShaderVariant::ForQuality(ShaderQuality quality) {
+  ShaderVariant variant;
+  variant.quality = quality;
+  if (quality == ShaderQuality::Low) {
+    // На слабых машинах обходимся без полутени и преломления
+    variant.softShadows = false;
+    variant.refraction = false;
+  }
+  return variant;
+}
+
+std::string ShaderVariant::ToDefines() const {
+  QualityLimits limits = GetLimits(quality);
+  std::ostringstream out;
+  out << "#define MAX_BOUNCES " << limits.maxBounces << "\n"
+      << "#define MAX_STEP_COUNT " << limits.maxStepCount << "\n"
+      << "#define SHADOW_STEPS " << limits.shadowSteps << "\n"
+      << "#define SOFT_SHADOWS " << (softShadows ? 1 : 0) << "\n"
+      << "#define MATERIAL_TEXTURES " << (textures ? 1 : 0) << "\n"
+      << "#define REFRACTION " << (refraction ? 1 : 0) << "\n";
+  if (staticCount >= 0) {
+    out << "#define STATIC_COUNT " << staticCount << "\n";
+  }
+  return out.str();
+}
+
+uint64_t ShaderVariant::ToKey() const {
+  uint64_t key = static_cast<uint32_t>(staticCount + 1);
+  key = (key << 2) | static_cast<uint64_t>(quality);
+  key = (key << 1) | (softShadows ? 1 : 0);
+  key = (key << 1) | (textures ? 1 : 0);
+  key = (key << 1) | (refraction ? 1 : 0);
+  return key;
+}
+
+std::string ShaderVariant::ToString() const {
+  std::ostringstream out;
+  out << GetLimits(quality).name << (softShadows ? "+soft" : "")
+      << (textures ? "+tex" : "") << (refraction ? "+refr" : "") << "/"
+      << staticCount;
+  return out.str();
+}
+
+ShaderPermutations::ShaderPermutations(const std::string& vertexPath,
+                                       const std::string& fragmentPath,
+                                       SetupFunction setup)
+    : vertexPath_(vertexPath),
+      fragmentPath_(fragmentPath),
+      setup_(std::move(setup)) {}
+
+const Shader* ShaderPermutations::Get(const ShaderVariant& variant) {
+  uint64_t key = variant.ToKey();
+  auto it = variants_.find(key);
+  if (it != variants_.end()) {
+    return it->second.get();
+  }
+
+  auto shader = std::make_unique<Shader>(vertexPath_, fragmentPath_,
+                                         variant.ToDefines());
+  if (shader->getID() == 0) {
+    std::cerr << "Failed to build shader variant '" << variant.ToString()
+              << "'" << std::endl;
+    shader.reset();
+  } else if (setup_) {
+    setup_(*shader);
+  }
+  return (variants_[key] = std::move(shader)).get();
+}
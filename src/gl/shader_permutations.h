@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "shader.h"
+
+// Уровень качества raymarch-шейдера
+enum class ShaderQuality { Low, Medium, High };
+
+// Разбирает "low" / "medium" / "high"; бросает std::runtime_error
+ShaderQuality ParseShaderQuality(const std::string& name);
+
+// Набор констант, с которыми компилируется вариант шейдера
+struct ShaderVariant {
+  ShaderQuality quality = ShaderQuality::High;
+  bool softShadows = true;  // Мягкие тени (иначе - жёсткие)
+  bool textures = true;     // Текстуры материалов
+  bool refraction = true;   // Преломление в прозрачных объектах
+  int staticCount = -1;     // Число статических коробок (-1 - из UBO)
+
+  // Варианты по умолчанию для уровня качества
+  static ShaderVariant ForQuality(ShaderQuality quality);
+
+  // Блок #define для вставки в исходник
+  std::string ToDefines() const;
+
+  // Ключ кэша: одинаков у вариантов с одинаковыми константами. Поля
+  // упакованы в число, чтобы поиск варианта каждый кадр не строил строку
+  uint64_t ToKey() const;
+
+  // Описание варианта для сообщений ("low+tex/-1")
+  std::string ToString() const;
+};
+
+// Лениво компилирует варианты одной шейдерной программы и хранит их по
+// ключу. Выключенные возможности вырезаются препроцессором, поэтому
+// слабые машины не платят за ветвления, которые им не нужны
+class ShaderPermutations {
+ public:
+  // Вызывается для каждого нового варианта сразу после компиляции
+  // (привязка uniform-блоков, сэмплеров и т.п.)
+  using SetupFunction = std::function<void(const Shader&)>;
+
+  ShaderPermutations(const std::string& vertexPath,
+                     const std::string& fragmentPath,
+                     SetupFunction setup = nullptr);
+
+  // Вариант из кэша или только что собранный; nullptr, если шейдер не
+  // скомпилировался (ошибка тоже кэшируется)
+  const Shader* Get(const ShaderVariant& variant);
+
+  size_t GetCompiledCount() const { return variants_.size(); }
+
+ private:
+  std::string vertexPath_;
+  std::string fragmentPath_;
+  SetupFunction setup_;
+  std::unordered_map<uint64_t, std::unique_ptr<Shader>> variants_;
+};
@@ -0,0 +1,133 @@
+#include "stream_buffer.h"
+#include <iostream>
+#include "gl_extensions.h"
+
+// Максимальное ожидание освобождения региона (нс)
+constexpr GLuint64 kFenceTimeout = 1000000000;
+
+StreamBuffer::StreamBuffer(GLenum target, size_t regionSize, int regionCount)
+    : target_(target), regionSize_(regionSize), regionCount_(regionCount) {
+  // Смещения UBO должны быть кратны выравниванию реализации
+  if (target_ == GL_UNIFORM_BUFFER) {
+    GLint alignment = 1;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    size_t align = static_cast<size_t>(alignment);
+    regionSize_ = (regionSize_ + align - 1) / align * align;
+  }
+
+  glGenBuffers(1, &buffer_);
+  glBindBuffer(target_, buffer_);
+
+  const GLExtensions& ext = GLExtensions::GetInstance();
+  if (ext.hasBufferStorage) {
+    GLsizeiptr total = static_cast<GLsizeiptr>(regionSize_ * regionCount_);
+    GLbitfield flags =
+        GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    ext.BufferStorage(target_, total, nullptr, flags);
+    mapped_ = glMapBufferRange(target_, 0, total, flags);
+    if (mapped_) {
+      fences_.assign(regionCount_, nullptr);
+    } else {
+      // Хранилище неизменяемое, поэтому буфер создаётся заново - для
+      // осиротевания через glBufferData
+      std::cerr << "StreamBuffer: persistent mapping failed, falling back "
+                << "to buffer orphaning" << std::endl;
+      glBindBuffer(target_, 0);
+      glDeleteBuffers(1, &buffer_);
+      glGenBuffers(1, &buffer_);
+      glBindBuffer(target_, buffer_);
+    }
+  }
+  if (!mapped_) {
+    // Без постоянного отображения нужен только один регион
+    regionCount_ = 1;
+    glBufferData(target_, static_cast<GLsizeiptr>(regionSize_), nullptr,
+                 GL_STREAM_DRAW);
+  }
+
+  glBindBuffer(target_, 0);
+}
+
+StreamBuffer::~StreamBuffer() {
+  for (GLsync fence : fences_) {
+    if (fence) {
+      glDeleteSync(fence);
+    }
+  }
+  if (mapped_) {
+    glBindBuffer(target_, buffer_);
+    glUnmapBuffer(target_);
+    glBindBuffer(target_, 0);
+  }
+  glDeleteBuffers(1, &buffer_);
+}
+
+void* StreamBuffer::BeginWrite() {
+  skipped_ = false;
+  if (mapped_) {
+    // Ждём, пока GPU дочитает регион, записанный regionCount_ кадров назад
+    GLsync& fence = fences_[current_];
+    if (fence) {
+      GLenum status =
+          glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, kFenceTimeout);
+      if (status == GL_TIMEOUT_EXPIRED) {
+        // Регион всё ещё читается: запись в него испортила бы кадр GPU.
+        // Fence остаётся, регион проверяется снова в следующем кадре
+        std::cerr << "StreamBuffer: GPU is still reading the region, "
+                  << "skipping this update" << std::endl;
+        skipped_ = true;
+        return nullptr;
+      }
+      if (status == GL_WAIT_FAILED) {
+        glFinish();  // Ожидание не сработало - дожидаемся GPU целиком
+      }
+      glDeleteSync(fence);
+      fence = nullptr;
+    }
+    return static_cast<char*>(mapped_) + GetOffset();
+  }
+
+  // Осиротевание: старое содержимое остаётся GPU, запись идёт в новое
+  glBindBuffer(target_, buffer_);
+  glBufferData(target_, static_cast<GLsizeiptr>(regionSize_), nullptr,
+               GL_STREAM_DRAW);
+  void* data =
+      glMapBufferRange(target_, 0, static_cast<GLsizeiptr>(regionSize_),
+                       GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+  if (!data) {
+    std::cerr << "StreamBuffer: glMapBufferRange failed, skipping this "
+              << "update" << std::endl;
+    glBindBuffer(target_, 0);
+    skipped_ = true;
+  }
+  return data;
+}
+
+void StreamBuffer::EndWrite(size_t size, GLuint bindingPoint) {
+  if (!mapped_) {
+    glUnmapBuffer(target_);
+    glBindBuffer(target_, 0);
+  }
+
+  if (target_ == GL_UNIFORM_BUFFER) {
+    glBindBufferRange(target_, bindingPoint, buffer_,
+                      static_cast<GLintptr>(GetOffset()),
+                      static_cast<GLsizeiptr>(size));
+  }
+}
+
+void StreamBuffer::EndFrame() {
+  // Регион не записывался: его fence и номер остаются до следующего кадра
+  if (skipped_) {
+    skipped_ = false;
+    return;
+  }
+  if (mapped_) {
+    fences_[current_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  }
+  current_ = (current_ + 1) % regionCount_;
+}
+
+size_t StreamBuffer::GetOffset() const {
+  return regionSize_ * current_;
+}
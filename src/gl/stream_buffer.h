@@ -0,0 +1,51 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstddef>
+#include <vector>
+
+// Кольцевой буфер для данных, обновляемых каждый кадр.
+// Буфер делится на несколько регионов: пока GPU читает регион прошлого
+// кадра, CPU пишет в следующий. При наличии GL_ARB_buffer_storage буфер
+// постоянно отображён в память, а занятость регионов отслеживается
+// fence-объектами. Иначе каждый кадр буфер "осиротевает" (glBufferData с
+// nullptr), и драйвер сам выделяет свободную память
+class StreamBuffer {
+ public:
+  StreamBuffer(GLenum target, size_t regionSize, int regionCount = 3);
+  ~StreamBuffer();
+
+  StreamBuffer(const StreamBuffer&) = delete;
+  StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+  // Возвращает память очередного региона для записи (не больше
+  // GetRegionSize() байт). При необходимости ждёт, пока GPU его освободит.
+  // Если регион так и не освободился или буфер не отобразился, возвращает
+  // nullptr: запись в этом кадре пропускается, EndWrite не вызывается
+  void* BeginWrite();
+
+  // Завершает запись size байт. Для UBO регион привязывается к точке
+  // bindingPoint
+  void EndWrite(size_t size, GLuint bindingPoint);
+
+  // Отмечает, что команды, читающие текущий регион, отправлены GPU.
+  // Вызывается после отрисовки кадра
+  void EndFrame();
+
+  // Смещение текущего региона от начала буфера (в байтах)
+  size_t GetOffset() const;
+
+  GLuint GetBuffer() const { return buffer_; }
+  size_t GetRegionSize() const { return regionSize_; }
+  bool IsPersistent() const { return mapped_ != nullptr; }
+
+ private:
+  GLenum target_;
+  GLuint buffer_ = 0;
+  size_t regionSize_;  // Размер региона с учётом выравнивания смещений
+  int regionCount_;
+  int current_ = 0;
+
+  void* mapped_ = nullptr;     // Постоянное отображение (если есть)
+  std::vector<GLsync> fences_;  // Занятость регионов GPU
+  bool skipped_ = false;        // BeginWrite в этом кадре не удался
+};
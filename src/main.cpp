@@ -1,9 +1,51 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include "core/application.h"
 
 int main(int argc, char* argv[]) {
+  // Разбор параметров командной строки
+  ApplicationOptions options;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--threaded-physics") == 0) {
+      options.threadedSimulation = true;
+    } else if (std::strcmp(argv[i], "--physics-rate") == 0 && i + 1 < argc) {
+      options.physicsRate = std::max(1, std::atoi(argv[++i]));
+    } else if (std::strcmp(argv[i], "--render-scale") == 0 && i + 1 < argc) {
+      float scale = static_cast<float>(std::atof(argv[++i]));
+      options.renderScale = std::clamp(scale, 0.25f, 1.0f);
+    } else if (std::strcmp(argv[i], "--target-fps") == 0 && i + 1 < argc) {
+      float fps = static_cast<float>(std::atof(argv[++i]));
+      options.targetFPS = std::max(fps, 0.0f);
+    } else if (std::strcmp(argv[i], "--no-shader-cache") == 0) {
+      options.shaderCacheDirectory.clear();
+    } else if (std::strcmp(argv[i], "--texture-gpu-budget") == 0 &&
+               i + 1 < argc) {
+      // Бюджеты памяти текстур задаются в мегабайтах
+      size_t megabytes = std::strtoull(argv[++i], nullptr, 10);
+      options.textureBudget.gpuBytes = megabytes << 20;
+    } else if (std::strcmp(argv[i], "--texture-cpu-budget") == 0 &&
+               i + 1 < argc) {
+      size_t megabytes = std::strtoull(argv[++i], nullptr, 10);
+      options.textureBudget.cpuBytes = megabytes << 20;
+    } else if (std::strcmp(argv[i], "--keep-texture-copies") == 0) {
+      options.textureBudget.keepCpuCopies = true;
+    } else if (std::strcmp(argv[i], "--texture-report") == 0) {
+      options.textureReport = true;
+    } else if (std::strcmp(argv[i], "--quality") == 0 && i + 1 < argc) {
+      try {
+        options.quality = ParseShaderQuality(argv[++i]);
+      } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+      }
+    } else {
+      std::cerr << "Unknown argument: " << argv[i] << std::endl;
+    }
+  }
+
   // Создаем экземпляр приложения
-  Application app;
+  Application app(options);
 
   // Инициализируем ресурсы
   if (!app.Initialize()) {
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+
+// Значение полинома; коэффициенты от младшей степени к старшей
+inline double EvaluatePolynomial(const std::vector<double>& coeffs, double x) {
+  double result = 0.0;
+  for (auto it = coeffs.rbegin(); it != coeffs.rend(); ++it) {
+    result = result * x + *it;
+  }
+  return result;
+}
+
+// Вещественные корни полинома на отрезке [lo, hi] в порядке возрастания.
+// Между соседними корнями производной полином монотонен, поэтому каждый
+// такой интервал со сменой знака содержит ровно один корень (бисекция).
+inline std::vector<double> FindPolynomialRoots(std::vector<double> coeffs,
+                                               double lo,
+                                               double hi) {
+  // Отбрасываем нулевые старшие коэффициенты (вырожденные случаи)
+  while (!coeffs.empty() && std::abs(coeffs.back()) < 1e-12) {
+    coeffs.pop_back();
+  }
+
+  std::vector<double> roots;
+  if (coeffs.size() < 2) {
+    return roots;
+  }
+  if (coeffs.size() == 2) {
+    double x = -coeffs[0] / coeffs[1];
+    if (x >= lo && x <= hi) {
+      roots.push_back(x);
+    }
+    return roots;
+  }
+
+  // Экстремумы: корни производной
+  std::vector<double> derivative(coeffs.size() - 1);
+  for (size_t i = 1; i < coeffs.size(); ++i) {
+    derivative[i - 1] = coeffs[i] * static_cast<double>(i);
+  }
+  std::vector<double> points{lo};
+  for (double x : FindPolynomialRoots(derivative, lo, hi)) {
+    points.push_back(x);
+  }
+  points.push_back(hi);
+
+  for (size_t i = 0; i + 1 < points.size(); ++i) {
+    double a = points[i];
+    double b = points[i + 1];
+    double fa = EvaluatePolynomial(coeffs, a);
+    double fb = EvaluatePolynomial(coeffs, b);
+
+    if (fa == 0.0) {
+      if (roots.empty() || roots.back() != a) {
+        roots.push_back(a);
+      }
+      continue;
+    }
+    if ((fa < 0.0) == (fb < 0.0)) {
+      continue;
+    }
+
+    // Бисекция на монотонном участке
+    for (int iteration = 0; iteration < 64 && b - a > 1e-12; ++iteration) {
+      double mid = 0.5 * (a + b);
+      double fm = EvaluatePolynomial(coeffs, mid);
+      if ((fm < 0.0) == (fa < 0.0)) {
+        a = mid;
+        fa = fm;
+      } else {
+        b = mid;
+      }
+    }
+    roots.push_back(0.5 * (a + b));
+  }
+  return roots;
+}
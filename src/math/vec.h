@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <iostream>
 
 inline constexpr float kMinDistance = 0.001f;
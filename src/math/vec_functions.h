@@ -250,6 +250,37 @@ inline quat operator+(const quat& a, const quat& b) {
   return quat(a.w + b.w, a.x + b.x, a.y + b.y, a.z + b.z);
 }
 
+// Кватернион поворота на вектор theta (ось * угол в радианах)
+inline quat quatFromRotationVector(const vec3& theta) {
+  float angle = length(theta);
+  if (angle < 1e-8f) {
+    return quat(1.0f, 0.0f, 0.0f, 0.0f);
+  }
+  float s = std::sin(0.5f * angle) / angle;
+  return quat(std::cos(0.5f * angle), theta[0] * s, theta[1] * s,
+              theta[2] * s);
+}
+
+// Сферическая интерполяция кватернионов по кратчайшей дуге
+inline quat slerp(const quat& a, const quat& b, float t) {
+  float cosAngle = a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z;
+  quat end = b;
+  if (cosAngle < 0.0f) {
+    cosAngle = -cosAngle;
+    end = b * -1.0f;
+  }
+
+  // Для близких поворотов достаточно линейной интерполяции
+  if (cosAngle > 0.9995f) {
+    return normalize(a * (1.0f - t) + end * t);
+  }
+
+  float angle = std::acos(cosAngle);
+  float invSin = 1.0f / std::sin(angle);
+  return a * (std::sin((1.0f - t) * angle) * invSin) +
+         end * (std::sin(t * angle) * invSin);
+}
+
 // Конвертация Кватерниона в Матрицу 3x3
 inline mat3<float> quatToMat3(const quat& q) {
   mat3<float> m;
@@ -271,3 +302,34 @@ inline mat3<float> quatToMat3(const quat& q) {
   m[2] = vec3(xz - wy, yz + wx, 1.0f - (xx + yy));
   return m;
 }
+
+// Транспонирование матрицы 3x3
+inline mat3<float> Transpose(const mat3<float>& m) {
+  mat3<float> t;
+  t[0] = vec3(m[0][0], m[1][0], m[2][0]);
+  t[1] = vec3(m[0][1], m[1][1], m[2][1]);
+  t[2] = vec3(m[0][2], m[1][2], m[2][2]);
+  return t;
+}
+
+// Умножение матриц 3x3
+inline mat3<float> MulMat(const mat3<float>& a, const mat3<float>& b) {
+  mat3<float> t = Transpose(b);
+  mat3<float> m;
+  for (int i = 0; i < 3; ++i) {
+    m[i] = vec3(dot(a[i], t[0]), dot(a[i], t[1]), dot(a[i], t[2]));
+  }
+  return m;
+}
+
+// Поворот диагональной матрицы: R * diag(d) * R^T
+// (перевод тензора из осей тела в мировые оси)
+inline mat3<float> RotateDiagonal(const mat3<float>& r, const vec3& d) {
+  mat3<float> m;
+  for (int i = 0; i < 3; ++i) {
+    vec3 scaledRow = r[i] * d;
+    m[i] = vec3(dot(scaledRow, r[0]), dot(scaledRow, r[1]),
+                dot(scaledRow, r[2]));
+  }
+  return m;
+}
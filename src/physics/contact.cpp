@@ -0,0 +1,37 @@
+#include "contact.h"
+#include <functional>
+
+size_t ContactKeyHash::operator()(const ContactKey& key) const {
+  // Комбинирование хешей (по мотивам boost::hash_combine)
+  size_t h = std::hash<const void*>()(key.bodyA);
+  h ^= std::hash<const void*>()(key.bodyB) + 0x9e3779b9 + (h << 6) + (h >> 2);
+  h ^= std::hash<int>()(key.featureId) + 0x9e3779b9 + (h << 6) + (h >> 2);
+  return h;
+}
+
+const CachedImpulse* ContactCache::Find(const ContactKey& key) const {
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    return nullptr;
+  }
+  return &it->second;
+}
+
+void ContactCache::Store(const Contact& contact) {
+  CachedImpulse& entry = entries_[contact.Key()];
+  entry.normalImpulse = contact.normalImpulse;
+  entry.frictionImpulse = contact.frictionImpulse;
+  entry.lastStep = currentStep_;
+}
+
+void ContactCache::NextStep() {
+  // Контакт, который не подтвердился на этом шаге, распался
+  std::erase_if(entries_, [this](const auto& item) {
+    return item.second.lastStep != currentStep_;
+  });
+  ++currentStep_;
+}
+
+void ContactCache::Clear() {
+  entries_.clear();
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include "math/vec.h"
+#include "render/scene_object.h"
+
+class PhysicsBody;
+
+// Ключ контакта: пара тел + геометрический элемент (грань/ребро/вершина)
+struct ContactKey {
+  const PhysicsBody* bodyA = nullptr;
+  const PhysicsBody* bodyB = nullptr;
+  int featureId = 0;
+
+  bool operator==(const ContactKey& other) const = default;
+};
+
+struct ContactKeyHash {
+  size_t operator()(const ContactKey& key) const;
+};
+
+// Контакт текущего шага вместе с накопленными импульсами решателя
+struct Contact {
+  PhysicsBody* bodyA = nullptr;
+  PhysicsBody* bodyB = nullptr;
+  CollisionManifold manifold;
+
+  vec3 rA{0.0f};              // Плечо точки контакта для тела A
+  vec3 rB{0.0f};              // Плечо точки контакта для тела B
+  float normalMass = 0.0f;    // Эффективная масса вдоль нормали
+  float velocityBias = 0.0f;  // Целевая скорость разлёта (упругость)
+  float friction = 0.0f;      // Коэффициент трения пары
+
+  float normalImpulse = 0.0f;  // Накопленный нормальный импульс
+  vec3 frictionImpulse{0.0f};  // Накопленный импульс трения
+
+  ContactKey Key() const { return {bodyA, bodyB, manifold.featureId}; }
+};
+
+// Импульсы, сохранённые с прошлого шага для тёплого старта
+struct CachedImpulse {
+  float normalImpulse = 0.0f;
+  vec3 frictionImpulse{0.0f};
+  uint32_t lastStep = 0;
+};
+
+// Постоянный кэш контактов между шагами физики
+class ContactCache {
+ public:
+  // Возвращает импульсы контакта с прошлого шага (или nullptr)
+  const CachedImpulse* Find(const ContactKey& key) const;
+
+  // Сохраняет накопленные импульсы контакта текущего шага
+  void Store(const Contact& contact);
+
+  // Удаляет контакты, не обновлённые на текущем шаге, и начинает новый
+  void NextStep();
+
+  void Clear();
+  size_t Size() const { return entries_.size(); }
+
+ private:
+  std::unordered_map<ContactKey, CachedImpulse, ContactKeyHash> entries_;
+  uint32_t currentStep_ = 0;
+};
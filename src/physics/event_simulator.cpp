@@ -0,0 +1,490 @@
+#include "event_simulator.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include "math/polynomial.h"
+#include "physics_body.h"
+#include "render/scene.h"
+#include "render/scene_object_box.h"
+#include "render/scene_object_sphere.h"
+
+constexpr double kNever = std::numeric_limits<double>::infinity();
+constexpr float kVelocityEpsilon = 1e-4f;  // Скорость, считающаяся нулевой
+constexpr float kSpinEpsilon = 1e-3f;  // Угловая скорость, считающаяся нулевой
+constexpr size_t kMaxEventsPerAdvance = 100000;  // Защита от зацикливания
+
+// Вертикаль стола
+static const vec3 kUp(0.0f, 0.0f, 1.0f);
+
+// Проекция вектора на плоскость стола
+static vec3 Planar(const vec3& v) {
+  return vec3(v[0], v[1], 0.0f);
+}
+
+// Первый момент s из [0, window], когда |P + V*s + A*s^2/2| = D и
+// расстояние при этом сокращается (kNever, если такого нет)
+static double FirstContact(const vec3& P,
+                           const vec3& V,
+                           const vec3& A,
+                           double D,
+                           double window) {
+  std::vector<double> coeffs{
+      dot(P, P) - D * D, 2.0 * dot(P, V), dot(V, V) + dot(P, A),
+      static_cast<double>(dot(V, A)), 0.25 * dot(A, A)};
+  if (coeffs[0] <= 0.0 && coeffs[1] < 0.0) {
+    return 0.0;  // Уже касаются и продолжают сближаться
+  }
+  auto derivative = [&](double s) {
+    return coeffs[1] + 2.0 * coeffs[2] * s + 3.0 * coeffs[3] * s * s +
+           4.0 * coeffs[4] * s * s * s;
+  };
+  for (double s : FindPolynomialRoots(coeffs, 0.0, window)) {
+    if (derivative(s) < 0.0) {
+      return s;
+    }
+  }
+  return kNever;
+}
+
+bool EventSimulator::Event::operator>(const Event& other) const {
+  if (time != other.time) {
+    return time > other.time;
+  }
+  if (a != other.a) {
+    return a > other.a;
+  }
+  return b > other.b;
+}
+
+bool EventSimulator::Build(Scene& scene, const vec3& gravity) {
+  balls_.clear();
+  cushions_.clear();
+  queue_ = {};
+  time_ = 0.0;
+  processedEvents_ = 0;
+  g_ = length(gravity);
+
+  // Неподвижные коробки: стол и борта
+  std::vector<Cushion> boxes;
+  for (const auto& entity : scene.GetEntities()) {
+    if (!entity->body || !entity->object) {
+      continue;
+    }
+    PhysicsBody* body = entity->body.get();
+
+    if (body->isStatic) {
+      auto* box = dynamic_cast<const Box*>(entity->object.get());
+      if (!box || std::abs(body->orientation.w) < 0.9999f) {
+        continue;  // Повёрнутые борта модель не поддерживает
+      }
+      vec3 center = body->GetPosition();
+      vec3 half = box->GetHalfExtents();
+      boxes.push_back({center - half, center + half,
+                       body->material->restitution});
+      continue;
+    }
+
+    // Подвижными могут быть только шары
+    auto* sphere = dynamic_cast<const Sphere*>(entity->object.get());
+    if (!sphere) {
+      return false;
+    }
+    Ball ball;
+    ball.body = body;
+    ball.radius = sphere->GetRadius();
+    ball.mass = body->mass;
+    ball.restitution = body->material->restitution;
+    balls_.push_back(ball);
+  }
+
+  if (balls_.empty()) {
+    return false;
+  }
+
+  // Каждый шар должен лежать на верхней грани одной из коробок (на столе)
+  float ballZ = balls_.front().body->GetPosition()[2];
+  float planeZ = 0.0f;
+  for (const auto& ball : balls_) {
+    vec3 p = ball.body->GetPosition();
+    bool supported = false;
+    for (const auto& box : boxes) {
+      bool inside = p[0] >= box.min[0] && p[0] <= box.max[0] &&
+                    p[1] >= box.min[1] && p[1] <= box.max[1];
+      if (inside && std::abs(p[2] - ball.radius - box.max[2]) <
+                        0.05f * ball.radius) {
+        supported = true;
+        planeZ = box.max[2];
+        break;
+      }
+    }
+    if (!supported || std::abs(p[2] - ballZ) > 0.05f * ball.radius) {
+      return false;
+    }
+  }
+
+  // Бортами считаются коробки, возвышающиеся над сукном на высоте шаров
+  for (const auto& box : boxes) {
+    if (box.max[2] > planeZ + kVelocityEpsilon && box.min[2] < ballZ) {
+      cushions_.push_back(box);
+    }
+  }
+
+  for (int i = 0; i < static_cast<int>(balls_.size()); ++i) {
+    const PhysicsBody* body = balls_[i].body;
+    StartSegment(i, 0.0, body->GetPosition(), body->GetVelocity(),
+                 body->angularVelocity, body->orientation);
+  }
+
+  // Первичное расписание: каждую пару шаров учитываем один раз
+  for (int i = 0; i < static_cast<int>(balls_.size()); ++i) {
+    if (balls_[i].endTime != kNever) {
+      queue_.push({balls_[i].endTime, EventType::Transition, i, -1,
+                   balls_[i].version, 0});
+    }
+    for (int j = i + 1; j < static_cast<int>(balls_.size()); ++j) {
+      ScheduleBallBall(i, j);
+    }
+    for (int c = 0; c < static_cast<int>(cushions_.size()); ++c) {
+      ScheduleBallCushion(i, c);
+    }
+  }
+  return true;
+}
+
+void EventSimulator::AdvanceTo(double time) {
+  size_t processed = 0;
+  while (!queue_.empty() && queue_.top().time <= time) {
+    Event event = queue_.top();
+    queue_.pop();
+    if (IsStale(event)) {
+      continue;
+    }
+
+    time_ = std::max(time_, event.time);
+    ProcessEvent(event);
+    ++processedEvents_;
+
+    if (++processed > kMaxEventsPerAdvance) {
+      std::cerr << "EventSimulator: too many events, simulation stalled at t="
+                << time_ << std::endl;
+      return;
+    }
+  }
+  time_ = std::max(time_, time);
+}
+
+double EventSimulator::RunUntilRest(double maxTime) {
+  while (!IsAtRest() && !queue_.empty() && queue_.top().time <= maxTime) {
+    AdvanceTo(queue_.top().time);
+  }
+  if (!IsAtRest()) {
+    AdvanceTo(maxTime);
+  }
+  return time_;
+}
+
+void EventSimulator::WriteBack() const {
+  for (const auto& ball : balls_) {
+    Kinematics k = Evaluate(ball, time_);
+    ball.body->SetPosition(k.position);
+    ball.body->SetVelocity(k.velocity);
+    ball.body->angularVelocity = k.angularVelocity;
+    ball.body->SetOrientation(k.orientation);
+  }
+}
+
+bool EventSimulator::IsAtRest() const {
+  return std::all_of(balls_.begin(), balls_.end(), [](const Ball& ball) {
+    return ball.state == MotionState::Stationary;
+  });
+}
+
+float EventSimulator::SpinDeceleration(const Ball& ball) const {
+  return 5.0f * params.spinningFriction * g_ / (2.0f * ball.radius);
+}
+
+EventSimulator::Kinematics EventSimulator::Evaluate(const Ball& ball,
+                                                    double time) const {
+  // Время от начала участка (не выходим за его конец)
+  double tau = std::clamp(time, ball.t0, std::max(ball.t0, ball.endTime));
+  float t = static_cast<float>(tau - ball.t0);
+  float R = ball.radius;
+
+  Kinematics k;
+  k.position = ball.r0;
+
+  // Вращение вокруг вертикали тормозится независимо от качения
+  float spin0 = ball.w0[2];
+  float spinSign = (spin0 < 0.0f) ? -1.0f : 1.0f;
+  float beta = SpinDeceleration(ball);
+  float spinTime = std::min(t, std::abs(spin0) / beta);
+  float spin = spinSign * (std::abs(spin0) - beta * spinTime);
+  float spinAngle = spinSign * (std::abs(spin0) * spinTime -
+                                0.5f * beta * spinTime * spinTime);
+
+  vec3 planarAngularVelocity{0.0f};
+  vec3 planarAngle{0.0f};  // Интеграл угловой скорости по времени
+
+  switch (ball.state) {
+    case MotionState::Sliding: {
+      // Трение скольжения тормозит центр и раскручивает шар
+      k.acceleration = ball.slideDir * (-params.slidingFriction * g_);
+      k.velocity = ball.v0 + k.acceleration * t;
+      k.position = ball.r0 + ball.v0 * t + k.acceleration * (0.5f * t * t);
+
+      vec3 angularAcc = cross(kUp, ball.slideDir) *
+                        (5.0f * params.slidingFriction * g_ / (2.0f * R));
+      vec3 w0 = Planar(ball.w0);
+      planarAngularVelocity = w0 + angularAcc * t;
+      planarAngle = w0 * t + angularAcc * (0.5f * t * t);
+      break;
+    }
+    case MotionState::Rolling: {
+      // Качение без проскальзывания: w = (up x v) / R
+      k.acceleration = normalize(ball.v0) * (-params.rollingFriction * g_);
+      k.velocity = ball.v0 + k.acceleration * t;
+      k.position = ball.r0 + ball.v0 * t + k.acceleration * (0.5f * t * t);
+
+      planarAngularVelocity = cross(kUp, k.velocity) * (1.0f / R);
+      planarAngle = cross(kUp, k.position - ball.r0) * (1.0f / R);
+      break;
+    }
+    case MotionState::Spinning:
+    case MotionState::Stationary:
+      break;
+  }
+
+  k.angularVelocity = planarAngularVelocity + kUp * spin;
+  k.orientation = normalize(
+      quatFromRotationVector(planarAngle + kUp * spinAngle) * ball.q0);
+  return k;
+}
+
+void EventSimulator::StartSegment(int index,
+                                  double time,
+                                  const vec3& position,
+                                  const vec3& velocity,
+                                  const vec3& angularVelocity,
+                                  const quat& orientation) {
+  Ball& ball = balls_[index];
+  float R = ball.radius;
+
+  ball.t0 = time;
+  ball.r0 = position;
+  ball.v0 = Planar(velocity);
+  ball.w0 = angularVelocity;
+  ball.q0 = orientation;
+  ball.slideDir = vec3(0.0f);
+  ++ball.version;
+
+  // Скорость точки касания сукна: u = v + w x (-R * up)
+  vec3 contactVelocity = Planar(ball.v0 - cross(ball.w0, kUp) * R);
+  float slideSpeed = length(contactVelocity);
+  float speed = length(ball.v0);
+  float spin = std::abs(ball.w0[2]);
+
+  if (slideSpeed > kVelocityEpsilon) {
+    ball.state = MotionState::Sliding;
+    ball.slideDir = contactVelocity * (1.0f / slideSpeed);
+    ball.endTime =
+        time + 2.0 * slideSpeed / (7.0 * params.slidingFriction * g_);
+  } else if (speed > kVelocityEpsilon) {
+    ball.state = MotionState::Rolling;
+    ball.endTime = time + speed / (params.rollingFriction * g_);
+  } else if (spin > kSpinEpsilon) {
+    ball.state = MotionState::Spinning;
+    ball.v0 = vec3(0.0f);
+    ball.endTime = time + spin / SpinDeceleration(ball);
+  } else {
+    ball.state = MotionState::Stationary;
+    ball.v0 = vec3(0.0f);
+    ball.w0 = vec3(0.0f);
+    ball.endTime = kNever;
+  }
+}
+
+void EventSimulator::ScheduleBall(int index) {
+  const Ball& ball = balls_[index];
+  if (ball.endTime != kNever) {
+    queue_.push({ball.endTime, EventType::Transition, index, -1, ball.version,
+                 0});
+  }
+  for (int j = 0; j < static_cast<int>(balls_.size()); ++j) {
+    if (j != index) {
+      ScheduleBallBall(std::min(index, j), std::max(index, j));
+    }
+  }
+  for (int c = 0; c < static_cast<int>(cushions_.size()); ++c) {
+    ScheduleBallCushion(index, c);
+  }
+}
+
+void EventSimulator::ScheduleBallBall(int a, int b) {
+  const Ball& ballA = balls_[a];
+  const Ball& ballB = balls_[b];
+  bool movingA = ballA.state == MotionState::Sliding ||
+                 ballA.state == MotionState::Rolling;
+  bool movingB = ballB.state == MotionState::Sliding ||
+                 ballB.state == MotionState::Rolling;
+  if (!movingA && !movingB) {
+    return;
+  }
+
+  // Оба участка траектории действительны до ближайшей смены режима
+  double window = std::min(ballA.endTime, ballB.endTime) - time_;
+  if (window <= 0.0) {
+    return;
+  }
+
+  // Относительное движение - квадратичное по времени:
+  // d(s) = P + V*s + A*s^2/2; столкновение при |d(s)| = Ra + Rb
+  Kinematics ka = Evaluate(ballA, time_);
+  Kinematics kb = Evaluate(ballB, time_);
+  double hit = FirstContact(Planar(ka.position - kb.position),
+                            Planar(ka.velocity - kb.velocity),
+                            Planar(ka.acceleration - kb.acceleration),
+                            ballA.radius + ballB.radius, window);
+  if (hit != kNever) {
+    queue_.push({time_ + hit, EventType::BallBall, a, b, ballA.version,
+                 ballB.version});
+  }
+}
+
+void EventSimulator::ScheduleBallCushion(int a, int cushion) {
+  const Ball& ball = balls_[a];
+  if (ball.state != MotionState::Sliding &&
+      ball.state != MotionState::Rolling) {
+    return;
+  }
+
+  double window = ball.endTime - time_;
+  const Cushion& box = cushions_[cushion];
+  Kinematics k = Evaluate(ball, time_);
+  float R = ball.radius;
+
+  // Грани борта, сдвинутые на радиус шара, вдоль осей X и Y. Центр шара
+  // касается грани, только пока проходит вдоль неё; за её концами шар
+  // встречает вертикальное ребро борта
+  double hit = kNever;
+  for (int axis = 0; axis < 2; ++axis) {
+    int other = 1 - axis;
+    for (int side = 0; side < 2; ++side) {
+      float face = (side == 0) ? box.min[axis] - R : box.max[axis] + R;
+      float towards = (side == 0) ? 1.0f : -1.0f;  // Направление к грани
+
+      // Шар должен находиться снаружи со стороны этой грани
+      if ((k.position[axis] - face) * towards > 0.0f) {
+        continue;
+      }
+
+      std::vector<double> coeffs{k.position[axis] - face, k.velocity[axis],
+                                 0.5 * k.acceleration[axis]};
+      for (double s : FindPolynomialRoots(coeffs, 0.0, window)) {
+        float fs = static_cast<float>(s);
+        float velocity = k.velocity[axis] + k.acceleration[axis] * fs;
+        float across = k.position[other] + k.velocity[other] * fs +
+                       0.5f * k.acceleration[other] * fs * fs;
+        if (velocity * towards > 0.0f && across >= box.min[other] &&
+            across <= box.max[other]) {
+          hit = std::min(hit, s);
+          break;
+        }
+      }
+    }
+  }
+
+  // Вертикальные рёбра: касание при |p(s) - ребро| = R на плоскости стола.
+  // Нормаль удара (от ближайшей точки борта) тогда идёт от ребра к центру
+  for (int corner = 0; corner < 4; ++corner) {
+    vec3 edge((corner & 1) ? box.max[0] : box.min[0],
+              (corner & 2) ? box.max[1] : box.min[1], 0.0f);
+    hit = std::min(hit, FirstContact(Planar(k.position) - edge,
+                                     Planar(k.velocity),
+                                     Planar(k.acceleration), R, window));
+  }
+
+  if (hit != kNever) {
+    queue_.push({time_ + hit, EventType::BallCushion, a, cushion, ball.version,
+                 0});
+  }
+}
+
+bool EventSimulator::IsStale(const Event& event) const {
+  if (balls_[event.a].version != event.versionA) {
+    return true;
+  }
+  return event.type == EventType::BallBall &&
+         balls_[event.b].version != event.versionB;
+}
+
+void EventSimulator::ProcessEvent(const Event& event) {
+  switch (event.type) {
+    case EventType::Transition: {
+      Ball& ball = balls_[event.a];
+      Kinematics k = Evaluate(ball, event.time);
+
+      // Фиксируем точное завершение режима, чтобы округление не
+      // порождало участки нулевой длины
+      if (ball.state == MotionState::Sliding) {
+        k.angularVelocity = cross(kUp, k.velocity) * (1.0f / ball.radius) +
+                            kUp * k.angularVelocity[2];
+      } else if (ball.state == MotionState::Rolling) {
+        k.velocity = vec3(0.0f);
+        k.angularVelocity = kUp * k.angularVelocity[2];
+      } else if (ball.state == MotionState::Spinning) {
+        k.angularVelocity = vec3(0.0f);
+      }
+
+      StartSegment(event.a, event.time, k.position, k.velocity,
+                   k.angularVelocity, k.orientation);
+      ScheduleBall(event.a);
+      break;
+    }
+    case EventType::BallBall: {
+      Ball& ballA = balls_[event.a];
+      Ball& ballB = balls_[event.b];
+      Kinematics ka = Evaluate(ballA, event.time);
+      Kinematics kb = Evaluate(ballB, event.time);
+
+      // Удар без трения между шарами: импульс вдоль линии центров
+      vec3 n = normalize(Planar(kb.position - ka.position));
+      float approach = dot(ka.velocity - kb.velocity, n);
+      if (approach > 0.0f) {
+        float e = std::min(ballA.restitution, ballB.restitution);
+        float invMassSum = 1.0f / ballA.mass + 1.0f / ballB.mass;
+        float j = (1.0f + e) * approach / invMassSum;
+        ka.velocity = ka.velocity - n * (j / ballA.mass);
+        kb.velocity = kb.velocity + n * (j / ballB.mass);
+      }
+
+      StartSegment(event.a, event.time, ka.position, ka.velocity,
+                   ka.angularVelocity, ka.orientation);
+      StartSegment(event.b, event.time, kb.position, kb.velocity,
+                   kb.angularVelocity, kb.orientation);
+      ScheduleBall(event.a);
+      ScheduleBall(event.b);
+      break;
+    }
+    case EventType::BallCushion: {
+      Ball& ball = balls_[event.a];
+      const Cushion& box = cushions_[event.b];
+      Kinematics k = Evaluate(ball, event.time);
+
+      // Нормаль от ближайшей точки борта к центру шара (учитывает углы)
+      vec3 closest(std::clamp(k.position[0], box.min[0], box.max[0]),
+                   std::clamp(k.position[1], box.min[1], box.max[1]), 0.0f);
+      vec3 n = normalize(Planar(k.position) - closest);
+      float normalSpeed = dot(k.velocity, n);
+      if (normalSpeed < 0.0f) {
+        float e = std::min(ball.restitution, box.restitution);
+        k.velocity = k.velocity - n * ((1.0f + e) * normalSpeed);
+      }
+
+      StartSegment(event.a, event.time, k.position, k.velocity,
+                   k.angularVelocity, k.orientation);
+      ScheduleBall(event.a);
+      break;
+    }
+  }
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <vector>
+#include "math/vec_functions.h"
+
+class Scene;
+class PhysicsBody;
+
+// Событийное моделирование шаров на плоскости стола.
+// Между столкновениями движение шара имеет аналитическое решение
+// (скольжение -> качение -> вращение на месте -> покой), поэтому вместо
+// фиксированного шага время сразу переводится к ближайшему событию:
+// столкновению шаров, удару о борт или смене режима движения.
+// Стол считается горизонтальным (ось Z вверх), борта - неподвижными
+// коробками, выровненными по осям.
+class EventSimulator {
+ public:
+  // Коэффициенты модели сукна
+  struct Parameters {
+    float slidingFriction = 0.2f;     // Трение скольжения шара по сукну
+    float rollingFriction = 0.01f;    // Сопротивление качению
+    float spinningFriction = 0.044f;  // Торможение вращения вокруг вертикали
+  };
+
+  Parameters params;
+
+  // Собирает шары и борта из сцены. Возвращает false, если сцена не
+  // подходит для событийной модели (шар не лежит на столе, есть подвижные
+  // коробки и т.п.)
+  bool Build(Scene& scene, const vec3& gravity);
+
+  // Переводит моделирование к моменту time, обрабатывая все события
+  void AdvanceTo(double time);
+  void Advance(double deltaTime) { AdvanceTo(time_ + deltaTime); }
+
+  // Моделирует до остановки всех шаров (но не дольше maxTime).
+  // Возвращает момент остановки
+  double RunUntilRest(double maxTime);
+
+  // Записывает состояние шаров на текущий момент в физические тела
+  void WriteBack() const;
+
+  double GetTime() const { return time_; }
+  bool IsAtRest() const;
+  size_t GetEventCount() const { return processedEvents_; }
+
+ private:
+  enum class MotionState { Stationary, Spinning, Rolling, Sliding };
+  enum class EventType { Transition, BallBall, BallCushion };
+
+  // Участок траектории шара, начатый в момент t0
+  struct Ball {
+    PhysicsBody* body = nullptr;
+    float radius = 0.0f;
+    float mass = 0.0f;
+    float restitution = 0.0f;
+
+    MotionState state = MotionState::Stationary;
+    double t0 = 0.0;  // Начало участка
+    vec3 r0{0.0f};    // Позиция центра в начале участка
+    vec3 v0{0.0f};    // Скорость центра
+    vec3 w0{0.0f};    // Угловая скорость
+    quat q0;          // Ориентация
+
+    vec3 slideDir{0.0f};   // Направление скольжения точки контакта
+    double endTime = 0.0;  // Момент смены режима движения
+    uint32_t version = 0;  // Счётчик для отбраковки устаревших событий
+  };
+
+  // Неподвижный борт (AABB в мировых осях)
+  struct Cushion {
+    vec3 min{0.0f};
+    vec3 max{0.0f};
+    float restitution = 0.0f;
+  };
+
+  // Кинематика шара в произвольный момент участка
+  struct Kinematics {
+    vec3 position{0.0f};
+    vec3 velocity{0.0f};
+    vec3 angularVelocity{0.0f};
+    vec3 acceleration{0.0f};
+    quat orientation;
+  };
+
+  struct Event {
+    double time = 0.0;
+    EventType type = EventType::Transition;
+    int a = -1;  // Индекс шара
+    int b = -1;  // Второй шар или борт
+    uint32_t versionA = 0;
+    uint32_t versionB = 0;
+
+    // Порядок очереди: раньше по времени, при равенстве - по индексам
+    bool operator>(const Event& other) const;
+  };
+
+  Kinematics Evaluate(const Ball& ball, double time) const;
+
+  // Начинает новый участок траектории с заданного состояния
+  void StartSegment(int index,
+                    double time,
+                    const vec3& position,
+                    const vec3& velocity,
+                    const vec3& angularVelocity,
+                    const quat& orientation);
+
+  // Пересчитывает события шара после смены его участка
+  void ScheduleBall(int index);
+  void ScheduleBallBall(int a, int b);
+  void ScheduleBallCushion(int a, int cushion);
+
+  void ProcessEvent(const Event& event);
+  bool IsStale(const Event& event) const;
+
+  // Торможение вращения вокруг вертикали, рад/с^2
+  float SpinDeceleration(const Ball& ball) const;
+
+  std::vector<Ball> balls_;
+  std::vector<Cushion> cushions_;
+  std::priority_queue<Event, std::vector<Event>, std::greater<Event>> queue_;
+
+  float g_ = 9.81f;
+  double time_ = 0.0;
+  size_t processedEvents_ = 0;
+};
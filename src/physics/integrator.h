@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdexcept>
+#include <string>
+
+// Схема численного интегрирования движения тел
+enum class IntegratorType {
+  SymplecticEuler,  // Полунеявный Эйлер (по умолчанию)
+  VelocityVerlet,   // Скоростной Верле: второй порядок по позиции
+  RK4,              // Рунге-Кутта 4-го порядка (плавное качение)
+};
+
+// Частота шага, под которую настроены коэффициенты затухания в сцене
+inline constexpr float kDampingReferenceRate = 60.0f;
+
+// Разбор имени интегратора из JSON-описания сцены
+inline IntegratorType ParseIntegratorType(const std::string& name) {
+  if (name == "symplectic_euler") {
+    return IntegratorType::SymplecticEuler;
+  }
+  if (name == "velocity_verlet") {
+    return IntegratorType::VelocityVerlet;
+  }
+  if (name == "rk4") {
+    return IntegratorType::RK4;
+  }
+  throw std::runtime_error("Unknown integrator: " + name);
+}
@@ -1,4 +1,6 @@
 #include "physics_body.h"
+#include <algorithm>
+#include <cmath>
 #include "math/vec_functions.h"
 
 PhysicsBody::PhysicsBody() {
@@ -6,36 +8,137 @@ PhysicsBody::PhysicsBody() {
   SetMass(1.0f);
 }
 
-void PhysicsBody::IntegrateState(float deltaTime) {
+// Перевод коэффициента затухания за шаг (настроен на kDampingReferenceRate)
+// в скорость экспоненциального затухания, не зависящую от длины шага
+static float DampingRate(float perStepFactor) {
+  if (perStepFactor >= 1.0f) {
+    return 0.0f;
+  }
+  return -std::log(std::max(perStepFactor, 1e-6f)) * kDampingReferenceRate;
+}
+
+// Производная ориентации: dq/dt = 0.5 * w * q
+static quat OrientationDerivative(const quat& q, const vec3& w) {
+  quat qVel(0.0f, w[0], w[1], w[2]);
+  return qVel * q * 0.5f;
+}
+
+void PhysicsBody::IntegrateState(float deltaTime, IntegratorType integrator) {
   if (isStatic || invMass == 0.0f) {
     return;
   }
 
-  // --- Линейное движение ---
+  // Силы и моменты постоянны в пределах шага
   vec3 resultingAcc = acceleration + (forceAccum * invMass);
-  velocity = velocity + resultingAcc * deltaTime;
-  position = position + velocity * deltaTime;
+  vec3 angularAcc = ApplyInvInertia(torqueAccum);
+
+  // Эмуляция сопротивления воздуха (линейное) и качению (угловое)
+  float linearRate = DampingRate(linearDamping);
+  float angularRate = DampingRate(angularDamping);
+
+  switch (integrator) {
+    case IntegratorType::SymplecticEuler:
+      IntegrateSymplecticEuler(deltaTime, resultingAcc, angularAcc, linearRate,
+                               angularRate);
+      break;
+    case IntegratorType::VelocityVerlet:
+      IntegrateVelocityVerlet(deltaTime, resultingAcc, angularAcc, linearRate,
+                              angularRate);
+      break;
+    case IntegratorType::RK4:
+      IntegrateRK4(deltaTime, resultingAcc, angularAcc, linearRate,
+                   angularRate);
+      break;
+  }
 
-  // Эмуляция сопротивления воздуха (линейное)
-  velocity = velocity * linearDamping;
+  // Нормализуем, иначе накопится ошибка и шар деформируется
+  orientation = normalize(orientation);
+  UpdateInertiaWorld();
 
-  // --- Вращательное движение ---
-  vec3 angularAcc = torqueAccum * invInertia;
-  angularVelocity = angularVelocity + angularAcc * deltaTime;
+  // Очистка сил для следующего кадра
+  ClearForces();
+}
+
+void PhysicsBody::IntegrateSymplecticEuler(float dt,
+                                           const vec3& acc,
+                                           const vec3& angularAcc,
+                                           float linearRate,
+                                           float angularRate) {
+  // --- Линейное движение ---
+  velocity = velocity + acc * dt;
+  position = position + velocity * dt;
 
-  // Эмуляция сопротивления качению (угловое)
-  angularVelocity = angularVelocity * angularDamping;
+  // Затухание за шаг dt (на 60 Гц совпадает с linearDamping)
+  velocity = velocity * std::exp(-linearRate * dt);
+
+  // --- Вращательное движение ---
+  angularVelocity = angularVelocity + angularAcc * dt;
+  angularVelocity = angularVelocity * std::exp(-angularRate * dt);
 
   // Интеграция ориентации с помощью кватернионов
-  quat qVel(0.0f, angularVelocity[0], angularVelocity[1], angularVelocity[2]);
-  quat spin = qVel * orientation * 0.5f;
-  orientation = orientation + spin * deltaTime;
+  orientation =
+      orientation + OrientationDerivative(orientation, angularVelocity) * dt;
+}
 
-  // Нормализуем, иначе накопится ошибка и шар деформируется
-  orientation = normalize(orientation);
+void PhysicsBody::IntegrateVelocityVerlet(float dt,
+                                          const vec3& acc,
+                                          const vec3& angularAcc,
+                                          float linearRate,
+                                          float angularRate) {
+  // --- Линейное движение ---
+  // Позиция: x += v*dt + a*dt^2/2, где a учитывает сопротивление среды
+  vec3 a0 = acc - velocity * linearRate;
+  position = position + velocity * dt + a0 * (0.5f * dt * dt);
 
-  // Очистка сил для следующего кадра
-  ClearForces();
+  // Скорость: трапеция по ускорению, затухание в конце шага неявное
+  velocity = (velocity + (a0 + acc) * (0.5f * dt)) /
+             (1.0f + 0.5f * linearRate * dt);
+
+  // --- Вращательное движение ---
+  // Ориентацию поворачиваем со скоростью середины шага
+  vec3 alpha0 = angularAcc - angularVelocity * angularRate;
+  vec3 midAngularVelocity = angularVelocity + alpha0 * (0.5f * dt);
+  orientation = orientation +
+                OrientationDerivative(orientation, midAngularVelocity) * dt;
+
+  angularVelocity = (angularVelocity + (alpha0 + angularAcc) * (0.5f * dt)) /
+                    (1.0f + 0.5f * angularRate * dt);
+}
+
+void PhysicsBody::IntegrateRK4(float dt,
+                               const vec3& acc,
+                               const vec3& angularAcc,
+                               float linearRate,
+                               float angularRate) {
+  // Состояние тела и его производная по времени
+  struct State {
+    vec3 x, v, w;
+    quat q;
+  };
+  auto derivative = [&](const State& s) {
+    State d;
+    d.x = s.v;
+    d.v = acc - s.v * linearRate;
+    d.w = angularAcc - s.w * angularRate;
+    d.q = OrientationDerivative(s.q, s.w);
+    return d;
+  };
+  auto advance = [](const State& s, const State& d, float h) {
+    return State{s.x + d.x * h, s.v + d.v * h, s.w + d.w * h, s.q + d.q * h};
+  };
+
+  State s0{position, velocity, angularVelocity, orientation};
+  State k1 = derivative(s0);
+  State k2 = derivative(advance(s0, k1, 0.5f * dt));
+  State k3 = derivative(advance(s0, k2, 0.5f * dt));
+  State k4 = derivative(advance(s0, k3, dt));
+
+  // x += dt/6 * (k1 + 2*k2 + 2*k3 + k4)
+  float h = dt / 6.0f;
+  position = position + (k1.x + 2.0f * (k2.x + k3.x) + k4.x) * h;
+  velocity = velocity + (k1.v + 2.0f * (k2.v + k3.v) + k4.v) * h;
+  angularVelocity = angularVelocity + (k1.w + 2.0f * (k2.w + k3.w) + k4.w) * h;
+  orientation = orientation + (k1.q + (k2.q + k3.q) * 2.0f + k4.q) * h;
 }
 
 // Приложение центральной силы (только движение)
@@ -61,6 +164,16 @@ void PhysicsBody::ApplyForceAtPoint(const vec3& force, const vec3& point) {
   torqueAccum = torqueAccum + cross(r, force);
 }
 
+// Приложение импульса с плечом r относительно центра масс
+void PhysicsBody::ApplyImpulse(const vec3& impulse, const vec3& r) {
+  if (isStatic) {
+    return;
+  }
+
+  velocity = velocity + impulse * invMass;
+  angularVelocity = angularVelocity + ApplyInvInertia(cross(r, impulse));
+}
+
 // Очистка накопленных сил и моментов
 void PhysicsBody::ClearForces() {
   forceAccum = vec3(0.0f);
@@ -72,43 +185,50 @@ void PhysicsBody::SetMass(float m) {
   if (mass <= 0.0f) {
     invMass = 0.0f;
     isStatic = true;
-    invInertia = 0.0f;
   } else {
     invMass = 1.0f / mass;
     isStatic = false;
-    SetInertiaSphere(1.0f);
   }
+  // Форма тела не меняется: моменты масштабируются вместе с массой
+  UpdateInertia();
 }
 
 void PhysicsBody::SetInertiaSphere(float radius) {
-  if (isStatic) {
-    return;
-  }
   // I = (2/5) * m * r^2
-  float I = 0.4f * mass * radius * radius;
-  invInertia = (I != 0.0f) ? 1.0f / I : 0.0f;
+  inertiaPerMass = vec3(0.4f * radius * radius);
+  UpdateInertia();
 }
 
 void PhysicsBody::SetInertiaBox(const vec3& halfExtents) {
-  if (isStatic) {
-    return;
-  }
-
-  // Упрощенный расчет момента инерции для скалярного значения (аппроксимация)
   float w2 = halfExtents[0] * halfExtents[0];
   float h2 = halfExtents[1] * halfExtents[1];
   float d2 = halfExtents[2] * halfExtents[2];
 
-  // Грубое приближение для float: среднее арифметическое инерций по осям
-  float I_xx =
-      (1.0f / 3.0f) * mass * (h2 + d2);  // 1/3 т.к. halfExtents, а не full size
-  float I_yy = (1.0f / 3.0f) * mass * (w2 + d2);
-  float I_zz = (1.0f / 3.0f) * mass * (w2 + h2);
+  // Главные моменты по осям коробки (1/3 т.к. halfExtents, а не full size)
+  inertiaPerMass = vec3((h2 + d2) / 3.0f, (w2 + d2) / 3.0f, (w2 + h2) / 3.0f);
+  UpdateInertia();
+}
 
-  // Средняя инерция по трем осям
-  float I_avg = (I_xx + I_yy + I_zz) / 3.0f;
+void PhysicsBody::SetOrientation(const quat& q) {
+  orientation = normalize(q);
+  UpdateInertiaWorld();
+}
+
+vec3 PhysicsBody::ApplyInvInertia(const vec3& v) const {
+  return MulMatVec(invInertiaWorld, v);
+}
+
+void PhysicsBody::UpdateInertia() {
+  for (int axis = 0; axis < 3; ++axis) {
+    float I = mass * inertiaPerMass[axis];
+    invInertiaLocal[axis] = (!isStatic && I > 0.0f) ? 1.0f / I : 0.0f;
+  }
+  UpdateInertiaWorld();
+}
 
-  invInertia = (I_avg != 0.0f) ? 1.0f / I_avg : 0.0f;
+void PhysicsBody::UpdateInertiaWorld() {
+  // I_world^-1 = R * I_local^-1 * R^T
+  invInertiaWorld = RotateDiagonal(quatToMat3(orientation), invInertiaLocal);
 }
 
 void PhysicsBody::SetVelocity(const vec3& v) {
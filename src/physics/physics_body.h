@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include "integrator.h"
 #include "math/vec_functions.h"
 #include "physics_material.h"
 
@@ -20,9 +21,14 @@ class PhysicsBody {
   vec3 torqueAccum{0.0f};      // Сумма вращающих моментов (Н*м)
 
   // Инерционные параметры
-  float mass = 1.0f;        // Масса (кг)
-  float invMass = 1.0f;     // Обратная масса (1/кг)
-  float invInertia = 0.0f;  // Обратный момент инерции (1/(кг*м^2))
+  float mass = 1.0f;     // Масса (кг)
+  float invMass = 1.0f;  // Обратная масса (1/кг)
+
+  // Тензор инерции. В осях тела он диагонален, поэтому хранятся только
+  // главные моменты; мировой тензор пересчитывается при смене ориентации
+  vec3 inertiaPerMass{0.4f};    // Главные моменты на единицу массы (м^2)
+  vec3 invInertiaLocal{0.0f};   // Обратные главные моменты (1/(кг*м^2))
+  mat3<float> invInertiaWorld;  // Обратный тензор в мировых осях
 
   // Свойства симуляции
   float linearDamping = 0.995f;  // Коэф. сопротивления среды для позиции
@@ -33,18 +39,50 @@ class PhysicsBody {
 
   PhysicsBody();
 
-  void IntegrateState(float deltaTime);
+  void IntegrateState(
+      float deltaTime,
+      IntegratorType integrator = IntegratorType::SymplecticEuler);
   void ApplyForce(const vec3& force);
   void ApplyForceAtPoint(const vec3& force, const vec3& point);
+  void ApplyImpulse(const vec3& impulse, const vec3& r);
   void ClearForces();
 
   void SetMass(float m);
   void SetInertiaSphere(float radius);
   void SetInertiaBox(const vec3& halfExtents);
+  void SetOrientation(const quat& q);
+
+  // Применяет мировой обратный тензор инерции к вектору (момент -> ускорение)
+  vec3 ApplyInvInertia(const vec3& v) const;
 
   void SetVelocity(const vec3& v);
   vec3 GetVelocity() const;
 
   void SetPosition(const vec3& p);
   vec3 GetPosition() const;
+
+ private:
+  // Шаги интегрирования; acc/angularAcc постоянны в пределах шага,
+  // linearRate/angularRate - скорости экспоненциального затухания (1/с)
+  void IntegrateSymplecticEuler(float dt,
+                                const vec3& acc,
+                                const vec3& angularAcc,
+                                float linearRate,
+                                float angularRate);
+  void IntegrateVelocityVerlet(float dt,
+                               const vec3& acc,
+                               const vec3& angularAcc,
+                               float linearRate,
+                               float angularRate);
+  void IntegrateRK4(float dt,
+                    const vec3& acc,
+                    const vec3& angularAcc,
+                    float linearRate,
+                    float angularRate);
+
+  // Пересчёт обратных моментов из массы и формы
+  void UpdateInertia();
+
+  // Пересчёт мирового тензора из текущей ориентации
+  void UpdateInertiaWorld();
 };
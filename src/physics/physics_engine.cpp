@@ -1,31 +1,48 @@
 #include "physics_engine.h"
 #include <algorithm>
 #include <cmath>
+#include <iostream>
+#include "core/job_system.h"
 #include "math/vec_functions.h"
 
 constexpr float kFrictionThreshold =
     1e-4f;  // Порог касательной скорости для трения
 constexpr float kRestingVelocityThreshold =
-    0.05f;  // Порог нормальной скорости для "залипания"
+    0.05f;  // Порог скорости сближения, ниже которого отскока нет
+constexpr size_t kBodiesPerJob = 64;   // Тел в одной задаче интегрирования
+constexpr size_t kPairRowsPerJob = 4;  // Строк матрицы пар в одной задаче
+
+// Эффективная масса пары тел вдоль направления dir с учётом вращения
+static float EffectiveMass(const PhysicsBody* bodyA,
+                           const PhysicsBody* bodyB,
+                           const vec3& rA,
+                           const vec3& rB,
+                           const vec3& dir) {
+  vec3 rnA = cross(rA, dir);
+  vec3 rnB = cross(rB, dir);
+  float k = bodyA->invMass + bodyB->invMass +
+            dot(rnA, bodyA->ApplyInvInertia(rnA)) +
+            dot(rnB, bodyB->ApplyInvInertia(rnB));
+  return (k > 0.0f) ? 1.0f / k : 0.0f;
+}
+
+// Подготовка контакта: разделение объектов, эффективные массы и тёплый старт
+static void PrepareContact(Contact& contact,
+                           const CachedImpulse* cached,
+                           bool warmStarting) {
+  PhysicsBody* bodyA = contact.bodyA;
+  PhysicsBody* bodyB = contact.bodyB;
+  const CollisionManifold& manifold = contact.manifold;
 
-void ResolveCollision(PhysicsBody* bodyA,
-                      PhysicsBody* bodyB,
-                      const CollisionManifold& manifold) {
   // Разделение объектов (Positional Correction)
   // Физически раздвигаем объекты, чтобы они не находились друг в друге.
-
   const float percent = 0.8f;  // Процент исправления (мягкое разделение)
   const float slop = 0.01f;    // Допуск проникновения (защита от дрожания)
 
-  // Вычисляем обратную массу (для законов Ньютона)
   float invMassA = bodyA->invMass;
   float invMassB = bodyB->invMass;
   float invMassSum = invMassA + invMassB;
 
-  if (invMassSum == 0.0f) {
-    return;  // Оба объекта статичны
-  }
-
   // Вектор коррекции: насколько нужно раздвинуть объекты вдоль нормали
   vec3 correction = manifold.normal * (std::max(manifold.depth - slop, 0.0f) /
                                        invMassSum * percent);
@@ -37,95 +54,111 @@ void ResolveCollision(PhysicsBody* bodyA,
     bodyB->SetPosition(bodyB->GetPosition() - correction * invMassB);
   }
 
-  // Импульс (Отскок)
-  vec3 rA = manifold.contactPoint - bodyA->GetPosition();
-  vec3 rB = manifold.contactPoint - bodyB->GetPosition();
-
-  vec3 velA = bodyA->GetVelocity() + cross(bodyA->angularVelocity, rA);
-  vec3 velB = bodyB->GetVelocity() + cross(bodyB->angularVelocity, rB);
-
-  vec3 rv = velA - velB;
-  float velAlongNormal = dot(rv, manifold.normal);
-
-  // Если объекты удаляются друг от друга, не трогаем их
-  if (velAlongNormal > 0) {
-    return;
-  }
-
-  // Вычисляем упругость (берем минимальную из двух)
-  float e =
-      std::min(bodyA->material->restitution, bodyB->material->restitution);
-
-  // Стабилизация (Resting Contact)
-  if (velAlongNormal > -kRestingVelocityThreshold) {
-    e = 0.0f;
+  contact.rA = manifold.contactPoint - bodyA->GetPosition();
+  contact.rB = manifold.contactPoint - bodyB->GetPosition();
+  contact.normalMass =
+      EffectiveMass(bodyA, bodyB, contact.rA, contact.rB, manifold.normal);
+
+  // Коэффициент трения пары
+  contact.friction =
+      std::sqrt(bodyA->material->friction * bodyA->material->friction +
+                bodyB->material->friction * bodyB->material->friction);
+
+  // Упругость учитываем только при заметной скорости сближения, иначе
+  // покоящийся контакт будет бесконечно подпрыгивать
+  vec3 velA = bodyA->GetVelocity() + cross(bodyA->angularVelocity, contact.rA);
+  vec3 velB = bodyB->GetVelocity() + cross(bodyB->angularVelocity, contact.rB);
+  float velAlongNormal = dot(velA - velB, manifold.normal);
+
+  contact.velocityBias = 0.0f;
+  if (velAlongNormal < -kRestingVelocityThreshold) {
+    float e =
+        std::min(bodyA->material->restitution, bodyB->material->restitution);
+    contact.velocityBias = -e * velAlongNormal;
   }
 
-  // Вычисляем импульсный множитель
-  float j = -(1.0f + e) * velAlongNormal;
-  j /= invMassSum;
+  // Тёплый старт: повторно прикладываем импульсы прошлого шага
+  contact.normalImpulse = 0.0f;
+  contact.frictionImpulse = vec3(0.0f);
+  if (warmStarting && cached) {
+    contact.normalImpulse = cached->normalImpulse;
 
-  // Применяем импульс к скоростям
-  vec3 impulse = manifold.normal * j;
+    // Нормаль могла повернуться: оставляем только касательную часть трения
+    vec3 f = cached->frictionImpulse;
+    contact.frictionImpulse = f - manifold.normal * dot(f, manifold.normal);
 
-  if (!bodyA->isStatic) {
-    bodyA->SetVelocity(bodyA->GetVelocity() + impulse * invMassA);
+    vec3 impulse =
+        manifold.normal * contact.normalImpulse + contact.frictionImpulse;
+    bodyA->ApplyImpulse(impulse, contact.rA);
+    bodyB->ApplyImpulse(-impulse, contact.rB);
   }
-  if (!bodyB->isStatic) {
-    bodyB->SetVelocity(bodyB->GetVelocity() - impulse * invMassB);
-  }
-
-  // Трение (Friction Impulse) и Вращение
-  velA = bodyA->GetVelocity() + cross(bodyA->angularVelocity, rA);
-  velB = bodyB->GetVelocity() + cross(bodyB->angularVelocity, rB);
-  rv = velA - velB;
+}
 
-  vec3 tangent = rv - (manifold.normal * dot(rv, manifold.normal));
-  float tangentLen = length(tangent);
+// Одна итерация последовательных импульсов для контакта
+static void SolveContact(Contact& contact) {
+  PhysicsBody* bodyA = contact.bodyA;
+  PhysicsBody* bodyB = contact.bodyB;
+  const vec3& normal = contact.manifold.normal;
 
-  if (tangentLen > kFrictionThreshold) {
-    tangent = tangent * (1.0f / tangentLen);
+  // Импульс (Отскок)
+  vec3 velA = bodyA->GetVelocity() + cross(bodyA->angularVelocity, contact.rA);
+  vec3 velB = bodyB->GetVelocity() + cross(bodyB->angularVelocity, contact.rB);
+  float velAlongNormal = dot(velA - velB, normal);
 
-    // Импульс, необходимый для полной остановки скольжения
-    float jt = -dot(rv, tangent);
-    jt /= invMassSum;
+  // Накопленный импульс не может тянуть объекты друг к другу
+  float j = contact.normalMass * (contact.velocityBias - velAlongNormal);
+  float oldImpulse = contact.normalImpulse;
+  contact.normalImpulse = std::max(oldImpulse + j, 0.0f);
+  j = contact.normalImpulse - oldImpulse;
 
-    // Коэффициент трения
-    float mu = std::sqrt(bodyA->material->friction * bodyA->material->friction +
-                         bodyB->material->friction * bodyB->material->friction);
+  vec3 impulse = normal * j;
+  bodyA->ApplyImpulse(impulse, contact.rA);
+  bodyB->ApplyImpulse(-impulse, contact.rB);
 
-    float maxFriction = j * mu;
+  // Трение (Friction Impulse) и Вращение
+  velA = bodyA->GetVelocity() + cross(bodyA->angularVelocity, contact.rA);
+  velB = bodyB->GetVelocity() + cross(bodyB->angularVelocity, contact.rB);
+  vec3 rv = velA - velB;
+  vec3 tangentVel = rv - (normal * dot(rv, normal));
 
-    // Кулоново трение: либо останавливаем (jt), либо скользим (maxFriction)
-    float frictionImpulseMagnitude =
-        (std::abs(jt) < maxFriction) ? jt
-                                     : ((jt > 0 ? 1.0f : -1.0f) * maxFriction);
+  float tangentSpeed = length(tangentVel);
+  if (tangentSpeed <= kFrictionThreshold) {
+    return;
+  }
 
-    vec3 frictionImpulse = tangent * frictionImpulseMagnitude;
+  // Импульс, необходимый для полной остановки скольжения
+  vec3 tangent = tangentVel * (1.0f / tangentSpeed);
+  float tangentMass =
+      EffectiveMass(bodyA, bodyB, contact.rA, contact.rB, tangent);
+  vec3 oldFriction = contact.frictionImpulse;
+  vec3 newFriction = oldFriction - tangent * (tangentSpeed * tangentMass);
+
+  // Кулоново трение: накопленный импульс ограничен конусом трения
+  float maxFriction = contact.friction * contact.normalImpulse;
+  float frictionLen = length(newFriction);
+  if (frictionLen > maxFriction) {
+    newFriction = (frictionLen > 0.0f)
+                      ? newFriction * (maxFriction / frictionLen)
+                      : vec3(0.0f);
+  }
+  contact.frictionImpulse = newFriction;
 
-    // Линейный импульс трения
-    if (!bodyA->isStatic) {
-      bodyA->SetVelocity(bodyA->GetVelocity() + frictionImpulse * invMassA);
-    }
-    if (!bodyB->isStatic) {
-      bodyB->SetVelocity(bodyB->GetVelocity() - frictionImpulse * invMassB);
-    }
+  vec3 frictionImpulse = newFriction - oldFriction;
+  bodyA->ApplyImpulse(frictionImpulse, contact.rA);
+  bodyB->ApplyImpulse(-frictionImpulse, contact.rB);
+}
 
-    // Вращающий момент от трения
-    if (!bodyA->isStatic) {
-      vec3 torqueImpulse = cross(rA, frictionImpulse);
-      bodyA->angularVelocity =
-          bodyA->angularVelocity + torqueImpulse * bodyA->invInertia;
-    }
-    if (!bodyB->isStatic) {
-      vec3 torqueImpulse = cross(rB, -frictionImpulse);
-      bodyB->angularVelocity =
-          bodyB->angularVelocity + torqueImpulse * bodyB->invInertia;
+void PhysicsEngine::Update(Scene& scene, float deltaTime) {
+  if (mode == SimulationMode::EventDriven) {
+    if (UpdateEventDriven(scene, deltaTime)) {
+      return;
     }
+    std::cerr << "Scene is not suitable for event-driven simulation, "
+                 "falling back to fixed step"
+              << std::endl;
+    mode = SimulationMode::FixedStep;
   }
-}
 
-void PhysicsEngine::Update(Scene& scene, float deltaTime) {
   // Применяем внешние силы
   ApplyGravity(scene);
 
@@ -136,47 +169,187 @@ void PhysicsEngine::Update(Scene& scene, float deltaTime) {
   IntegrateBodies(scene, deltaTime);
 }
 
-void PhysicsEngine::ApplyGravity(Scene& scene) {
-  for (auto& entity : scene.GetEntities()) {
-    if (entity->body && !entity->body->isStatic) {
-      // F = m * g
-      vec3 gravityForce = gravity * entity->body->mass;
-      entity->body->ApplyForce(gravityForce);
+bool PhysicsEngine::UpdateEventDriven(Scene& scene, float deltaTime) {
+  if (!eventSimulationReady_) {
+    if (!eventSimulator_.Build(scene, gravity)) {
+      return false;
     }
+    eventSimulationReady_ = true;
   }
+
+  // Шаг кадра только определяет момент выборки состояния: события
+  // обрабатываются в точные моменты между кадрами
+  eventSimulator_.Advance(deltaTime);
+  eventSimulator_.WriteBack();
+  return true;
+}
+
+void PhysicsEngine::ApplyGravity(Scene& scene) {
+  auto& entities = scene.GetEntities();
+  JobSystem::GetInstance().ParallelFor(
+      entities.size(), kBodiesPerJob, [&](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; ++i) {
+          PhysicsBody* body = entities[i]->body.get();
+          if (body && !body->isStatic) {
+            // F = m * g
+            vec3 gravityForce = gravity * body->mass;
+            body->ApplyForce(gravityForce);
+          }
+        }
+      });
 }
 
 void PhysicsEngine::IntegrateBodies(Scene& scene, float deltaTime) {
-  for (auto& entity : scene.GetEntities()) {
-    if (entity->body) {
-      entity->body->IntegrateState(deltaTime);
-    }
-  }
+  auto& entities = scene.GetEntities();
+  JobSystem::GetInstance().ParallelFor(
+      entities.size(), kBodiesPerJob, [&](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; ++i) {
+          if (entities[i]->body) {
+            entities[i]->body->IntegrateState(deltaTime, integrator);
+          }
+        }
+      });
 }
 
-void PhysicsEngine::ProcessCollisions(Scene& scene, float deltaTime) {
+void PhysicsEngine::FindContacts(Scene& scene) {
   auto& entities = scene.GetEntities();
   size_t count = entities.size();
+  JobSystem& jobs = JobSystem::GetInstance();
 
-  for (size_t i = 0; i < count; ++i) {
-    for (size_t j = i + 1; j < count; ++j) {
-      auto* entA = entities[i].get();
-      auto* entB = entities[j].get();
+  // Узкая фаза: строки матрицы пар делятся между потоками, каждый пишет
+  // в свой буфер
+  workerContacts_.resize(jobs.GetThreadCount());
+  for (auto& buffer : workerContacts_) {
+    buffer.clear();
+  }
 
-      if (!entA->body || !entB->body) {
-        continue;
+  jobs.ParallelFor(count, kPairRowsPerJob, [&](size_t begin, size_t end,
+                                               size_t worker) {
+    auto& buffer = workerContacts_[worker];
+    for (size_t i = begin; i < end; ++i) {
+      for (size_t j = i + 1; j < count; ++j) {
+        auto* entA = entities[i].get();
+        auto* entB = entities[j].get();
+
+        if (!entA->body || !entB->body) {
+          continue;
+        }
+
+        if (entA->body->isStatic && entB->body->isStatic) {
+          continue;
+        }
+
+        CollisionManifold manifold = entA->object->ComputeCollision(
+            entB->object.get(), entA->body.get(), entB->body.get());
+
+        if (manifold.isColliding) {
+          PairContact pair;
+          pair.indexA = i;
+          pair.indexB = j;
+          pair.contact.bodyA = entA->body.get();
+          pair.contact.bodyB = entB->body.get();
+          pair.contact.manifold = manifold;
+          buffer.push_back(pair);
+        }
       }
+    }
+  });
 
-      if (entA->body->isStatic && entB->body->isStatic) {
-        continue;
-      }
+  // Детерминированное слияние: порядок пар не зависит от числа потоков
+  pairs_.clear();
+  for (auto& buffer : workerContacts_) {
+    pairs_.insert(pairs_.end(), buffer.begin(), buffer.end());
+  }
+  std::sort(pairs_.begin(), pairs_.end(),
+            [](const PairContact& a, const PairContact& b) {
+              if (a.indexA != b.indexA) {
+                return a.indexA < b.indexA;
+              }
+              return a.indexB < b.indexB;
+            });
+
+  contacts_.clear();
+  for (const auto& pair : pairs_) {
+    contacts_.push_back(pair.contact);
+  }
+}
+
+// Корень множества с сжатием пути
+static size_t FindRoot(std::vector<size_t>& parent, size_t i) {
+  while (parent[i] != i) {
+    parent[i] = parent[parent[i]];
+    i = parent[i];
+  }
+  return i;
+}
 
-      CollisionManifold manifold = entA->object->ComputeCollision(
-          entB->object.get(), entA->body.get(), entB->body.get());
+void PhysicsEngine::BuildIslands(size_t bodyCount) {
+  // Тела, связанные контактами, объединяются в острова. Статические тела
+  // острова не связывают: импульсы их не двигают
+  std::vector<size_t> parent(bodyCount);
+  for (size_t i = 0; i < bodyCount; ++i) {
+    parent[i] = i;
+  }
 
-      if (manifold.isColliding) {
-        ResolveCollision(entA->body.get(), entB->body.get(), manifold);
-      }
+  for (const auto& pair : pairs_) {
+    if (pair.contact.bodyA->isStatic || pair.contact.bodyB->isStatic) {
+      continue;
+    }
+    size_t rootA = FindRoot(parent, pair.indexA);
+    size_t rootB = FindRoot(parent, pair.indexB);
+    if (rootA != rootB) {
+      parent[std::max(rootA, rootB)] = std::min(rootA, rootB);
     }
   }
+
+  // Острова нумеруются по первому контакту, контакты внутри острова
+  // сохраняют порядок слияния
+  std::vector<int> islandOfRoot(bodyCount, -1);
+  islands_.clear();
+  for (size_t c = 0; c < pairs_.size(); ++c) {
+    const PairContact& pair = pairs_[c];
+    size_t dynamicIndex =
+        pair.contact.bodyA->isStatic ? pair.indexB : pair.indexA;
+    size_t root = FindRoot(parent, dynamicIndex);
+    if (islandOfRoot[root] < 0) {
+      islandOfRoot[root] = static_cast<int>(islands_.size());
+      islands_.emplace_back();
+    }
+    islands_[islandOfRoot[root]].push_back(c);
+  }
+}
+
+void PhysicsEngine::ProcessCollisions(Scene& scene, float deltaTime) {
+  FindContacts(scene);
+  BuildIslands(scene.GetEntities().size());
+
+  // Острова не имеют общих подвижных тел и решаются независимо.
+  // Внутри острова порядок контактов тот же, что и при решении всей
+  // сцены одним потоком
+  JobSystem::GetInstance().ParallelFor(
+      islands_.size(), 1, [&](size_t begin, size_t end, size_t) {
+        for (size_t island = begin; island < end; ++island) {
+          const auto& indices = islands_[island];
+
+          // Подготовка и тёплый старт из кэша прошлого шага
+          for (size_t c : indices) {
+            Contact& contact = contacts_[c];
+            PrepareContact(contact, contactCache_.Find(contact.Key()),
+                           warmStarting);
+          }
+
+          // Итерации последовательных импульсов
+          for (int iteration = 0; iteration < solverIterations; ++iteration) {
+            for (size_t c : indices) {
+              SolveContact(contacts_[c]);
+            }
+          }
+        }
+      });
+
+  // Сохраняем накопленные импульсы для следующего шага
+  for (const auto& contact : contacts_) {
+    contactCache_.Store(contact);
+  }
+  contactCache_.NextStep();
 }
@@ -1,16 +1,51 @@
 #pragma once
 
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "contact.h"
+#include "event_simulator.h"
 #include "render/scene.h"
 
+// Способ продвижения моделирования во времени
+enum class SimulationMode {
+  FixedStep,    // Фиксированный шаг с решателем контактов
+  EventDriven,  // Аналитическое движение шаров между событиями
+};
+
+// Разбор режима моделирования из JSON-описания сцены
+inline SimulationMode ParseSimulationMode(const std::string& name) {
+  if (name == "fixed_step") {
+    return SimulationMode::FixedStep;
+  }
+  if (name == "event_driven") {
+    return SimulationMode::EventDriven;
+  }
+  throw std::runtime_error("Unknown simulation mode: " + name);
+}
+
 class PhysicsEngine {
  public:
   vec3 gravity{0.0f, 0.0f, -9.81f};  // Гравитация вниз по Z
+  int solverIterations = 4;          // Итерации решателя контактов за шаг
+  bool warmStarting = true;          // Тёплый старт импульсами прошлого шага
+  IntegratorType integrator = IntegratorType::SymplecticEuler;
+  SimulationMode mode = SimulationMode::FixedStep;
+
+  // Параметры сукна для событийного режима
+  EventSimulator::Parameters& EventParameters() {
+    return eventSimulator_.params;
+  }
 
   PhysicsEngine() = default;
 
   // Главный метод обновления физики
   void Update(Scene& scene, float deltaTime);
 
+  // Сбрасывает событийную модель; она будет собрана заново из текущего
+  // состояния тел (нужно после внешнего изменения скоростей, например удара)
+  void ResetEventSimulation() { eventSimulationReady_ = false; }
+
  private:
   // Применение гравитации ко всем объектам
   void ApplyGravity(Scene& scene);
@@ -18,6 +53,31 @@ class PhysicsEngine {
   // Проверка и разрешение коллизий
   void ProcessCollisions(Scene& scene, float deltaTime);
 
+  // Узкая фаза по всем парам тел (параллельно)
+  void FindContacts(Scene& scene);
+
+  // Разбиение контактов на независимые острова
+  void BuildIslands(size_t bodyCount);
+
   // Интеграция движения (позиция += скорость * время)
   void IntegrateBodies(Scene& scene, float deltaTime);
+
+  // Шаг событийной модели; false, если сцена ей не подходит
+  bool UpdateEventDriven(Scene& scene, float deltaTime);
+
+  // Контакт вместе с индексами сущностей пары (ключ порядка слияния)
+  struct PairContact {
+    size_t indexA = 0;
+    size_t indexB = 0;
+    Contact contact;
+  };
+
+  std::vector<Contact> contacts_;  // Контакты текущего шага
+  std::vector<PairContact> pairs_;
+  std::vector<std::vector<PairContact>> workerContacts_;  // Буферы потоков
+  std::vector<std::vector<size_t>> islands_;  // Индексы контактов островов
+  ContactCache contactCache_;      // Импульсы контактов между шагами
+
+  EventSimulator eventSimulator_;
+  bool eventSimulationReady_ = false;
 };
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <vector>
+#include "math/vec.h"
+
+// Положение тела, нужное для отрисовки
+struct BodyTransform {
+  vec3 position{0.0f};
+  quat orientation;
+};
+
+// Неизменяемый снимок состояния физики после шага моделирования.
+// Индексы transforms совпадают с индексами сущностей сцены
+struct PhysicsSnapshot {
+  double time = 0.0;  // Модельное время снимка (с)
+  std::vector<BodyTransform> transforms;
+};
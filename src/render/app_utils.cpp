@@ -33,10 +33,7 @@ bool AppUtils::InitRaymarchBallResources(
     return true;
   }
 
-  // Ограничиваем количество сфер и выделяем память
-  if (sphere_count > 16) {
-    sphere_count = 16;
-  }
+  // Выделяем память
   outMaterials.resize(sphere_count);
 
   // Конвертируем C++ материалы в GPU-совместимый формат
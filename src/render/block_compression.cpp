@@ -0,0 +1,436 @@
+#include "block_compression.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// Главная ось облака цветов блока (channels каналов): среднее и
+// направление наибольшего разброса (степенной метод по ковариации)
+static void PrincipalAxis(const uint8_t* rgba,
+                          int channels,
+                          float* mean,
+                          float* axis) {
+  for (int c = 0; c < channels; ++c) {
+    mean[c] = 0.0f;
+    for (int i = 0; i < 16; ++i) {
+      mean[c] += rgba[i * 4 + c];
+    }
+    mean[c] /= 16.0f;
+  }
+
+  float cov[4][4] = {};
+  for (int i = 0; i < 16; ++i) {
+    for (int a = 0; a < channels; ++a) {
+      for (int b = 0; b < channels; ++b) {
+        cov[a][b] += (rgba[i * 4 + a] - mean[a]) * (rgba[i * 4 + b] - mean[b]);
+      }
+    }
+  }
+
+  for (int c = 0; c < channels; ++c) {
+    axis[c] = 1.0f;
+  }
+  for (int iteration = 0; iteration < 8; ++iteration) {
+    float next[4] = {};
+    float norm = 0.0f;
+    for (int a = 0; a < channels; ++a) {
+      for (int b = 0; b < channels; ++b) {
+        next[a] += cov[a][b] * axis[b];
+      }
+      norm = std::max(norm, std::abs(next[a]));
+    }
+    if (norm < 1e-6f) {
+      break;  // Блок одного цвета
+    }
+    for (int c = 0; c < channels; ++c) {
+      axis[c] = next[c] / norm;
+    }
+  }
+}
+
+// Крайние точки проекций пикселей на главную ось
+static void AxisEndpoints(const uint8_t* rgba,
+                          int channels,
+                          float* low,
+                          float* high) {
+  float mean[4];
+  float axis[4];
+  PrincipalAxis(rgba, channels, mean, axis);
+
+  float minT = 0.0f;
+  float maxT = 0.0f;
+  float length = 0.0f;
+  for (int c = 0; c < channels; ++c) {
+    length += axis[c] * axis[c];
+  }
+  for (int i = 0; i < 16; ++i) {
+    float t = 0.0f;
+    for (int c = 0; c < channels; ++c) {
+      t += (rgba[i * 4 + c] - mean[c]) * axis[c];
+    }
+    t = length > 0.0f ? t / length : 0.0f;
+    minT = std::min(minT, t);
+    maxT = std::max(maxT, t);
+  }
+  for (int c = 0; c < channels; ++c) {
+    low[c] = std::clamp(mean[c] + axis[c] * minT, 0.0f, 255.0f);
+    high[c] = std::clamp(mean[c] + axis[c] * maxT, 0.0f, 255.0f);
+  }
+}
+
+static uint16_t PackRGB565(const float* color) {
+  int r = static_cast<int>(color[0] * 31.0f / 255.0f + 0.5f);
+  int g = static_cast<int>(color[1] * 63.0f / 255.0f + 0.5f);
+  int b = static_cast<int>(color[2] * 31.0f / 255.0f + 0.5f);
+  return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+static void UnpackRGB565(uint16_t value, uint8_t* rgb) {
+  int r = (value >> 11) & 31;
+  int g = (value >> 5) & 63;
+  int b = value & 31;
+  rgb[0] = static_cast<uint8_t>((r << 3) | (r >> 2));
+  rgb[1] = static_cast<uint8_t>((g << 2) | (g >> 4));
+  rgb[2] = static_cast<uint8_t>((b << 3) | (b >> 2));
+}
+
+// Палитра цветового блока BC1 (четыре цвета RGBA)
+static void ColorPalette(uint16_t c0,
+                         uint16_t c1,
+                         bool forceFourColors,
+                         uint8_t palette[4][4]) {
+  UnpackRGB565(c0, palette[0]);
+  UnpackRGB565(c1, palette[1]);
+  palette[0][3] = palette[1][3] = 255;
+  if (c0 > c1 || forceFourColors) {
+    for (int c = 0; c < 3; ++c) {
+      int a = palette[0][c];
+      int b = palette[1][c];
+      palette[2][c] = static_cast<uint8_t>((2 * a + b) / 3);
+      palette[3][c] = static_cast<uint8_t>((a + 2 * b) / 3);
+    }
+    palette[2][3] = palette[3][3] = 255;
+  } else {
+    // Трёхцветный режим: середина и прозрачный чёрный
+    for (int c = 0; c < 3; ++c) {
+      palette[2][c] = static_cast<uint8_t>((palette[0][c] + palette[1][c]) / 2);
+      palette[3][c] = 0;
+    }
+    palette[2][3] = 255;
+    palette[3][3] = 0;
+  }
+}
+
+static int ColorDistance(const uint8_t* a, const uint8_t* b) {
+  int dr = a[0] - b[0];
+  int dg = a[1] - b[1];
+  int db = a[2] - b[2];
+  return dr * dr + dg * dg + db * db;
+}
+
+// Цветовой блок BC1 (8 байт). Всегда четырёхцветный режим
+static void EncodeColorBlock(const uint8_t* rgba, uint8_t* block) {
+  float low[4];
+  float high[4];
+  AxisEndpoints(rgba, 3, low, high);
+  uint16_t c0 = PackRGB565(high);
+  uint16_t c1 = PackRGB565(low);
+  if (c0 < c1) {
+    std::swap(c0, c1);
+  }
+
+  uint32_t indices = 0;
+  if (c0 != c1) {
+    uint8_t palette[4][4];
+    ColorPalette(c0, c1, true, palette);
+    for (int i = 0; i < 16; ++i) {
+      int best = 0;
+      int bestDistance = ColorDistance(rgba + i * 4, palette[0]);
+      for (int p = 1; p < 4; ++p) {
+        int distance = ColorDistance(rgba + i * 4, palette[p]);
+        if (distance < bestDistance) {
+          best = p;
+          bestDistance = distance;
+        }
+      }
+      indices |= static_cast<uint32_t>(best) << (i * 2);
+    }
+  }
+
+  block[0] = static_cast<uint8_t>(c0);
+  block[1] = static_cast<uint8_t>(c0 >> 8);
+  block[2] = static_cast<uint8_t>(c1);
+  block[3] = static_cast<uint8_t>(c1 >> 8);
+  std::memcpy(block + 4, &indices, 4);  // Little-endian
+}
+
+static void DecodeColorBlock(const uint8_t* block,
+                             bool forceFourColors,
+                             uint8_t* rgba) {
+  uint16_t c0 = static_cast<uint16_t>(block[0] | (block[1] << 8));
+  uint16_t c1 = static_cast<uint16_t>(block[2] | (block[3] << 8));
+  uint8_t palette[4][4];
+  ColorPalette(c0, c1, forceFourColors, palette);
+  uint32_t indices;
+  std::memcpy(&indices, block + 4, 4);
+  for (int i = 0; i < 16; ++i) {
+    std::memcpy(rgba + i * 4, palette[(indices >> (i * 2)) & 3], 4);
+  }
+}
+
+void EncodeBC1Block(const uint8_t* rgba, uint8_t* block) {
+  EncodeColorBlock(rgba, block);
+}
+
+void DecodeBC1Block(const uint8_t* block, uint8_t* rgba) {
+  DecodeColorBlock(block, false, rgba);
+}
+
+// Палитра альфа-блока BC3: восемь уровней при a0 > a1, иначе шесть
+// уровней и крайние значения 0 и 255
+static void AlphaPalette(uint8_t a0, uint8_t a1, uint8_t palette[8]) {
+  palette[0] = a0;
+  palette[1] = a1;
+  if (a0 > a1) {
+    for (int i = 1; i < 7; ++i) {
+      palette[i + 1] = static_cast<uint8_t>(((7 - i) * a0 + i * a1) / 7);
+    }
+  } else {
+    for (int i = 1; i < 5; ++i) {
+      palette[i + 1] = static_cast<uint8_t>(((5 - i) * a0 + i * a1) / 5);
+    }
+    palette[6] = 0;
+    palette[7] = 255;
+  }
+}
+
+void EncodeBC3Block(const uint8_t* rgba, uint8_t* block) {
+  uint8_t a0 = 0;
+  uint8_t a1 = 255;
+  for (int i = 0; i < 16; ++i) {
+    a0 = std::max(a0, rgba[i * 4 + 3]);
+    a1 = std::min(a1, rgba[i * 4 + 3]);
+  }
+
+  uint64_t indices = 0;
+  if (a0 != a1) {
+    uint8_t palette[8];
+    AlphaPalette(a0, a1, palette);
+    for (int i = 0; i < 16; ++i) {
+      int alpha = rgba[i * 4 + 3];
+      int best = 0;
+      for (int p = 1; p < 8; ++p) {
+        if (std::abs(palette[p] - alpha) < std::abs(palette[best] - alpha)) {
+          best = p;
+        }
+      }
+      indices |= static_cast<uint64_t>(best) << (i * 3);
+    }
+  }
+  block[0] = a0;
+  block[1] = a1;
+  for (int i = 0; i < 6; ++i) {
+    block[2 + i] = static_cast<uint8_t>(indices >> (i * 8));
+  }
+  EncodeColorBlock(rgba, block + 8);
+}
+
+void DecodeBC3Block(const uint8_t* block, uint8_t* rgba) {
+  DecodeColorBlock(block + 8, true, rgba);
+  uint8_t palette[8];
+  AlphaPalette(block[0], block[1], palette);
+  uint64_t indices = 0;
+  for (int i = 0; i < 6; ++i) {
+    indices |= static_cast<uint64_t>(block[2 + i]) << (i * 8);
+  }
+  for (int i = 0; i < 16; ++i) {
+    rgba[i * 4 + 3] = palette[(indices >> (i * 3)) & 7];
+  }
+}
+
+// Веса интерполяции 4-битных индексов BC7
+static const int kBC7Weights[16] = {0,  4,  9,  13, 17, 21, 26, 30,
+                                    34, 38, 43, 47, 51, 55, 60, 64};
+
+// Запись и чтение битовых полей 128-битного блока (младшие биты первыми)
+static void WriteBits(uint8_t* block, int& position, uint32_t value, int bits) {
+  for (int i = 0; i < bits; ++i, ++position) {
+    if (value & (1u << i)) {
+      block[position >> 3] |= static_cast<uint8_t>(1 << (position & 7));
+    }
+  }
+}
+
+static uint32_t ReadBits(const uint8_t* block, int& position, int bits) {
+  uint32_t value = 0;
+  for (int i = 0; i < bits; ++i, ++position) {
+    value |= static_cast<uint32_t>((block[position >> 3] >> (position & 7)) & 1)
+             << i;
+  }
+  return value;
+}
+
+// Квантует опорную точку в 7 бит на канал + общий p-бит, выбирая p-бит
+// с меньшей ошибкой
+static void QuantizeBC7Endpoint(const float* color,
+                                uint8_t* quantized,
+                                int& pbit) {
+  float bestError = 1e30f;
+  for (int p = 0; p < 2; ++p) {
+    uint8_t candidate[4];
+    float error = 0.0f;
+    for (int c = 0; c < 4; ++c) {
+      int q = static_cast<int>(std::lround((color[c] - p) / 2.0f));
+      candidate[c] = static_cast<uint8_t>(std::clamp(q, 0, 127));
+      float restored = static_cast<float>((candidate[c] << 1) | p);
+      error += (restored - color[c]) * (restored - color[c]);
+    }
+    if (error < bestError) {
+      bestError = error;
+      pbit = p;
+      std::memcpy(quantized, candidate, 4);
+    }
+  }
+}
+
+// Режим 6 BC7 для опорных точек low/high: квантованные точки, p-биты и
+// индексы пикселей. Возвращает суммарную квадратичную ошибку
+static int FitBC7(const uint8_t* rgba,
+                  const float* low,
+                  const float* high,
+                  uint8_t q[2][4],
+                  int pbit[2],
+                  int indices[16]) {
+  QuantizeBC7Endpoint(low, q[0], pbit[0]);
+  QuantizeBC7Endpoint(high, q[1], pbit[1]);
+
+  // Восстановленные опорные точки и палитра из 16 цветов
+  int endpoints[2][4];
+  for (int e = 0; e < 2; ++e) {
+    for (int c = 0; c < 4; ++c) {
+      endpoints[e][c] = (q[e][c] << 1) | pbit[e];
+    }
+  }
+  int totalError = 0;
+  for (int i = 0; i < 16; ++i) {
+    int best = 0;
+    int bestError = 1 << 30;
+    for (int w = 0; w < 16; ++w) {
+      int error = 0;
+      for (int c = 0; c < 4; ++c) {
+        int value = ((64 - kBC7Weights[w]) * endpoints[0][c] +
+                     kBC7Weights[w] * endpoints[1][c] + 32) >>
+                    6;
+        int d = value - rgba[i * 4 + c];
+        error += d * d;
+      }
+      if (error < bestError) {
+        bestError = error;
+        best = w;
+      }
+    }
+    indices[i] = best;
+    totalError += bestError;
+  }
+  return totalError;
+}
+
+void EncodeBC7Block(const uint8_t* rgba, uint8_t* block) {
+  float low[4];
+  float high[4];
+  AxisEndpoints(rgba, 4, low, high);
+
+  uint8_t q[2][4];
+  int pbit[2];
+  int indices[16];
+  int error = FitBC7(rgba, low, high, q, pbit, indices);
+
+  // Уточнение опорных точек методом наименьших квадратов по выбранным
+  // индексам; новое решение берётся, только если ошибка уменьшилась
+  float a = 0.0f;
+  float b = 0.0f;
+  float c = 0.0f;
+  float x0[4] = {};
+  float x1[4] = {};
+  for (int i = 0; i < 16; ++i) {
+    float t = kBC7Weights[indices[i]] / 64.0f;
+    a += (1.0f - t) * (1.0f - t);
+    b += (1.0f - t) * t;
+    c += t * t;
+    for (int ch = 0; ch < 4; ++ch) {
+      x0[ch] += (1.0f - t) * rgba[i * 4 + ch];
+      x1[ch] += t * rgba[i * 4 + ch];
+    }
+  }
+  float det = a * c - b * b;
+  if (std::abs(det) > 1e-6f) {
+    for (int ch = 0; ch < 4; ++ch) {
+      low[ch] = std::clamp((c * x0[ch] - b * x1[ch]) / det, 0.0f, 255.0f);
+      high[ch] = std::clamp((a * x1[ch] - b * x0[ch]) / det, 0.0f, 255.0f);
+    }
+    uint8_t refinedQ[2][4];
+    int refinedP[2];
+    int refinedIndices[16];
+    if (FitBC7(rgba, low, high, refinedQ, refinedP, refinedIndices) < error) {
+      std::memcpy(q, refinedQ, sizeof(q));
+      std::memcpy(pbit, refinedP, sizeof(pbit));
+      std::memcpy(indices, refinedIndices, sizeof(indices));
+    }
+  }
+
+  // Старший бит индекса первого пикселя не хранится и должен быть нулём:
+  // иначе меняем опорные точки местами
+  if (indices[0] >= 8) {
+    std::swap(q[0], q[1]);
+    std::swap(pbit[0], pbit[1]);
+    for (int& index : indices) {
+      index = 15 - index;
+    }
+  }
+
+  std::memset(block, 0, 16);
+  int position = 0;
+  WriteBits(block, position, 1u << 6, 7);  // Режим 6
+  for (int c = 0; c < 4; ++c) {
+    WriteBits(block, position, q[0][c], 7);
+    WriteBits(block, position, q[1][c], 7);
+  }
+  WriteBits(block, position, pbit[0], 1);
+  WriteBits(block, position, pbit[1], 1);
+  WriteBits(block, position, indices[0], 3);
+  for (int i = 1; i < 16; ++i) {
+    WriteBits(block, position, indices[i], 4);
+  }
+}
+
+void DecodeBC7Block(const uint8_t* block, uint8_t* rgba) {
+  if ((block[0] & 0x7F) != (1 << 6)) {
+    for (int i = 0; i < 16; ++i) {
+      rgba[i * 4 + 0] = 255;
+      rgba[i * 4 + 1] = 0;
+      rgba[i * 4 + 2] = 255;
+      rgba[i * 4 + 3] = 255;
+    }
+    return;
+  }
+
+  int position = 7;
+  int q[2][4];
+  for (int c = 0; c < 4; ++c) {
+    q[0][c] = static_cast<int>(ReadBits(block, position, 7));
+    q[1][c] = static_cast<int>(ReadBits(block, position, 7));
+  }
+  int pbit[2];
+  pbit[0] = static_cast<int>(ReadBits(block, position, 1));
+  pbit[1] = static_cast<int>(ReadBits(block, position, 1));
+
+  for (int i = 0; i < 16; ++i) {
+    int index = static_cast<int>(ReadBits(block, position, i == 0 ? 3 : 4));
+    for (int c = 0; c < 4; ++c) {
+      int e0 = (q[0][c] << 1) | pbit[0];
+      int e1 = (q[1][c] << 1) | pbit[1];
+      rgba[i * 4 + c] = static_cast<uint8_t>(
+          ((64 - kBC7Weights[index]) * e0 + kBC7Weights[index] * e1 + 32) >>
+          6);
+    }
+  }
+}
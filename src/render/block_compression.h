@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+
+// Кодирование и декодирование блоков 4x4 форматов BC (S3TC/BPTC).
+// Блок пикселей - 16 значений RGBA построчно (64 байта).
+//
+// BC1 - 8 байт на блок: две опорные точки RGB565 и 2-битные индексы.
+// BC3 - 16 байт: альфа-блок (8 байт) и цветовой блок как в BC1.
+// BC7 - 16 байт; кодировщик пишет только режим 6 (одно подмножество,
+// RGBA 7+1 бит, 4-битные индексы), декодер понимает только его
+
+void EncodeBC1Block(const uint8_t* rgba, uint8_t* block);
+void EncodeBC3Block(const uint8_t* rgba, uint8_t* block);
+void EncodeBC7Block(const uint8_t* rgba, uint8_t* block);
+
+void DecodeBC1Block(const uint8_t* block, uint8_t* rgba);
+void DecodeBC3Block(const uint8_t* block, uint8_t* rgba);
+// Блоки других режимов BC7 декодируются в пурпурный цвет
+void DecodeBC7Block(const uint8_t* block, uint8_t* rgba);
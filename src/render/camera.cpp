@@ -74,12 +74,15 @@ void Camera::Rotate(float yawDegrees, float pitchDegrees) {
   cameraUp = normalize(cross(right, viewVec));
 }
 
-// Пересчёт screenDist по FOV и разрешению
+// Пересчёт screenDist по FOV и разрешению. Кадрирование как в шейдере
+// (raymarch_fragment.glsl): луч view * tan(fov / 2) + up * v, где v
+// пробегает [-0.5, 0.5] по высоте кадра. Высота экрана в мировых
+// единицах - hResolution / pixInMillimeter, как в GetRay
 void Camera::RecalculateScreenDist() {
   float halfFovRad = fovDeg * M_PI / 360.0f;
-  float halfScreenWidthMm = float(wResolution) / 2.0f * pixInMillimeter;
+  float screenHeight = float(hResolution) / pixInMillimeter;
 
-  screenDist = halfScreenWidthMm / std::tan(halfFovRad);
+  screenDist = screenHeight * std::tan(halfFovRad);
 }
 
 // Меняем разрешение и пересчитываем экран
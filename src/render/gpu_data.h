@@ -1,7 +1,20 @@
 #pragma once
 #include "math/vec.h"
 
-// Структура PBR материала (32 байта)
+// Текстурные юниты raymarch-шейдера
+constexpr int kMaterialTextureUnit = 1;  // Массив текстур (юнит 0 - texture1)
+constexpr int kSceneDataUnit = 2;        // Данные попаданий для увеличения
+constexpr int kMaterialBufferUnit = 11;  // Таблица материалов (TBO)
+constexpr int kStaticBufferUnit = 12;    // Статическая геометрия (TBO)
+constexpr int kGridCellsUnit = 13;       // Ячейки сетки объектов
+constexpr int kGridIndicesUnit = 14;     // Индексы объектов ячеек (TBO)
+constexpr int kObjectBufferUnit = 15;    // Буфер объектов (TBO)
+
+// Типы объектов в буфере объектов
+constexpr int kGPUObjectSphere = 0;
+constexpr int kGPUObjectBox = 1;
+
+// Структура PBR материала (32 байта = 2 текселя таблицы материалов)
 struct GPUMaterial {
   // Блок 1 (16 байт)
   float r, g, b;    // Базовый цвет
@@ -11,34 +24,42 @@ struct GPUMaterial {
   float metallic;      // Металличность
   float transmission;  // Прозрачность
   float refraction;    // Коэффициент преломления
-  int textureID;       // Индекс текстурного юнита
+  int textureID;       // Слой массива materialTextures (-1 - без текстуры)
 };
 
-// Структура одного шара (96 байт)
-struct GPUBall {
-  // Позиция (16 байт)
-  // vec3 position занимает 12 байт, но в std140 выравнивание идет по 16 байт
+// Структура одного объекта (80 байт = 5 текселей RGBA32F).
+// Объекты лежат в texture buffer, поэтому их число ограничено только
+// размером буфера. Материал задан индексом в таблице материалов, которая
+// загружается один раз на сцену
+struct GPUObject {
+  // Тексель 0: позиция и тип
   float px, py, pz;
-  float _pad0;  // Выравнивание до 16 байт
+  float type;  // kGPUObjectSphere / kGPUObjectBox
+
+  // Тексель 1: размер (радиус сферы в sx или полуразмеры коробки) и
+  // индекс материала
+  float sx, sy, sz;
+  float material;
 
-  // Вращение (48 байт)
-  // В std140 матрица mat3 хранится как массив из 3-х векторов vec4
+  // Тексели 2-4: вращение, столбцы матрицы 3x3
   float rotCol0[4];
   float rotCol1[4];
   float rotCol2[4];
-
-  // Материал (32 байта)
-  GPUMaterial material;
 };
 
-// Главный блок данных, передаваемый в Uniform Buffer Object (UBO)
+// Заголовок буфера объектов, передаваемый в Uniform Buffer Object (UBO)
 struct UBOData {
-  // Глобальные параметры (16 байт)
-  float ballRadius;  // Радиус всех шаров
-  int ballCount;     // Текущее количество шаров
-  float _pad1;       // Выравнивание до 16 байт
-  float _pad2;       // Выравнивание до 16 байт
-
-  // Массив шаров
-  GPUBall balls[16];
+  // Объекты (16 байт)
+  int objectCount;    // Текущее количество объектов
+  int objectBase;     // Первый тексель объектов этого кадра в TBO
+  int gridIndexBase;  // Первый тексель индексов сетки этого кадра
+  int staticCount;    // Число неподвижных коробок в статическом буфере
+
+  // Сетка объектов (32 байта)
+  float gridMinX, gridMinY;   // Угол сетки на плоскости стола
+  float gridCellSize;         // Размер ячейки
+  float gridMargin;           // Запас, с которым объекты внесены в ячейки
+  int gridWidth, gridHeight;  // Число ячеек (0 - сетки нет)
+  int _pad1;                  // Выравнивание до 16 байт
+  int _pad2;                  // Выравнивание до 16 байт
 };
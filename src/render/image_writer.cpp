@@ -0,0 +1,416 @@
+#include "image_writer.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "bmp/bmp.h"
+#include "pixel_kernels.h"
+#include "raw_image.h"
+
+namespace {
+
+// Байты строки BMP с выравниванием по 4
+uint32_t BMPStride(uint32_t width) {
+  return ((width * 24 + 31) / 32) * 4;
+}
+
+void PutU32LE(std::vector<uint8_t>& out, uint32_t value) {
+  for (int i = 0; i < 4; ++i) {
+    out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+  }
+}
+
+void PutU32BE(std::vector<uint8_t>& out, uint32_t value) {
+  for (int i = 3; i >= 0; --i) {
+    out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+  }
+}
+
+void PutU64LE(std::vector<uint8_t>& out, uint64_t value) {
+  for (int i = 0; i < 8; ++i) {
+    out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+  }
+}
+
+void PutFloat(std::vector<uint8_t>& out, float value) {
+  uint32_t bits = 0;
+  std::memcpy(&bits, &value, sizeof(bits));
+  PutU32LE(out, bits);
+}
+
+void PutString(std::vector<uint8_t>& out, const char* text) {
+  out.insert(out.end(), text, text + std::strlen(text) + 1);
+}
+
+// BMP сверху вниз (отрицательная высота), строки пишутся без перекладки
+class BMPWriter : public ImageWriter {
+ public:
+  BMPWriter(std::ofstream stream, uint32_t width, uint32_t height)
+      : ImageWriter(std::move(stream), width, height) {}
+
+ protected:
+  bool WriteHeader() override {
+    bmpInfo info;
+    info.imageInfo.fWidth = width_;
+    info.imageInfo.fHeight =
+        static_cast<uint32_t>(-static_cast<int32_t>(height_));
+    info.imageInfo.fSizeImage = BMPStride(width_) * height_;
+    info.fileInfo.fDataOffset = sizeof(bmpInfo);
+    info.fileInfo.fSize = sizeof(bmpInfo) + info.imageInfo.fSizeImage;
+    out_.write(reinterpret_cast<const char*>(&info), sizeof(info));
+    return true;
+  }
+
+  void EncodeRow(const uint8_t* bgr) override {
+    static const char padding[4] = {};
+    const uint32_t bytes = width_ * 3;
+    out_.write(reinterpret_cast<const char*>(bgr), bytes);
+    out_.write(padding, BMPStride(width_) - bytes);
+  }
+};
+
+// Двоичный PPM (P6)
+class PPMWriter : public ImageWriter {
+ public:
+  PPMWriter(std::ofstream stream, uint32_t width, uint32_t height)
+      : ImageWriter(std::move(stream), width, height) {}
+
+ protected:
+  bool WriteHeader() override {
+    out_ << "P6\n" << width_ << ' ' << height_ << "\n255\n";
+    return true;
+  }
+
+  void EncodeRow(const uint8_t* bgr) override {
+    row_.resize(width_ * 3);
+    SwapRedBlueRow(bgr, row_.data(), width_);
+    out_.write(reinterpret_cast<const char*>(row_.data()), row_.size());
+  }
+
+ private:
+  std::vector<uint8_t> row_;
+};
+
+// PNG без сжатия: поток zlib из несжатых (stored) блоков deflate, по
+// чанку IDAT на строку. Так строку можно выдать сразу, без zlib и без
+// буфера на весь кадр
+class PNGWriter : public ImageWriter {
+ public:
+  PNGWriter(std::ofstream stream, uint32_t width, uint32_t height)
+      : ImageWriter(std::move(stream), width, height) {}
+
+ protected:
+  bool WriteHeader() override {
+    static const uint8_t signature[8] = {0x89, 'P',  'N',  'G',
+                                         '\r', '\n', 0x1A, '\n'};
+    out_.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+
+    std::vector<uint8_t> ihdr;
+    PutU32BE(ihdr, width_);
+    PutU32BE(ihdr, height_);
+    ihdr.push_back(8);  // Бит на канал
+    ihdr.push_back(2);  // RGB
+    ihdr.push_back(0);  // Deflate
+    ihdr.push_back(0);  // Без фильтров сверх построчных
+    ihdr.push_back(0);  // Без чересстрочности
+    WriteChunk("IHDR", ihdr);
+    return true;
+  }
+
+  void EncodeRow(const uint8_t* bgr) override {
+    // Строка PNG: байт фильтра (0 - без фильтра) и пиксели RGB
+    row_.resize(1 + width_ * 3);
+    row_[0] = 0;
+    SwapRedBlueRow(bgr, row_.data() + 1, width_);
+    UpdateAdler(row_);
+
+    chunk_.clear();
+    if (CurrentRow() == 0) {
+      chunk_.push_back(0x78);  // Заголовок zlib: deflate, окно 32 КиБ
+      chunk_.push_back(0x01);
+    }
+    const bool lastRow = CurrentRow() + 1 == height_;
+    size_t offset = 0;
+    while (offset < row_.size()) {
+      const size_t length = std::min<size_t>(row_.size() - offset, 65535);
+      const bool final = lastRow && offset + length == row_.size();
+      chunk_.push_back(final ? 1 : 0);
+      chunk_.push_back(static_cast<uint8_t>(length));
+      chunk_.push_back(static_cast<uint8_t>(length >> 8));
+      chunk_.push_back(static_cast<uint8_t>(~length));
+      chunk_.push_back(static_cast<uint8_t>(~length >> 8));
+      chunk_.insert(chunk_.end(), row_.begin() + offset,
+                    row_.begin() + offset + length);
+      offset += length;
+    }
+    if (lastRow) {
+      PutU32BE(chunk_, (adlerB_ << 16) | adlerA_);
+    }
+    WriteChunk("IDAT", chunk_);
+  }
+
+  void WriteTrailer() override { WriteChunk("IEND", {}); }
+
+ private:
+  static const std::array<uint32_t, 256>& CRCTable() {
+    static const std::array<uint32_t, 256> table = [] {
+      std::array<uint32_t, 256> result{};
+      for (uint32_t n = 0; n < 256; ++n) {
+        uint32_t c = n;
+        for (int k = 0; k < 8; ++k) {
+          c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        }
+        result[n] = c;
+      }
+      return result;
+    }();
+    return table;
+  }
+
+  static uint32_t UpdateCRC(uint32_t crc, const uint8_t* data, size_t size) {
+    const auto& table = CRCTable();
+    for (size_t i = 0; i < size; ++i) {
+      crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+  }
+
+  void UpdateAdler(const std::vector<uint8_t>& data) {
+    // 5552 - наибольшая длина, при которой сумма не переполняет 32 бита
+    size_t offset = 0;
+    while (offset < data.size()) {
+      const size_t end = std::min<size_t>(offset + 5552, data.size());
+      for (; offset < end; ++offset) {
+        adlerA_ += data[offset];
+        adlerB_ += adlerA_;
+      }
+      adlerA_ %= 65521;
+      adlerB_ %= 65521;
+    }
+  }
+
+  void WriteChunk(const char* type, const std::vector<uint8_t>& data) {
+    std::vector<uint8_t> header;
+    PutU32BE(header, static_cast<uint32_t>(data.size()));
+    header.insert(header.end(), type, type + 4);
+    out_.write(reinterpret_cast<const char*>(header.data()), header.size());
+    out_.write(reinterpret_cast<const char*>(data.data()), data.size());
+
+    uint32_t crc = UpdateCRC(0xFFFFFFFFu, header.data() + 4, 4);
+    crc = UpdateCRC(crc, data.data(), data.size()) ^ 0xFFFFFFFFu;
+    std::vector<uint8_t> footer;
+    PutU32BE(footer, crc);
+    out_.write(reinterpret_cast<const char*>(footer.data()), footer.size());
+  }
+
+  std::vector<uint8_t> row_;
+  std::vector<uint8_t> chunk_;
+  uint32_t adlerA_ = 1;
+  uint32_t adlerB_ = 0;
+};
+
+// Упрощённый OpenEXR: одна часть, строки по одной, без сжатия, каналы
+// B, G, R в 32-битном float. Хранит линейный цвет без тонмаппинга
+class EXRWriter : public ImageWriter {
+ public:
+  EXRWriter(std::ofstream stream, uint32_t width, uint32_t height)
+      : ImageWriter(std::move(stream), width, height) {}
+
+ protected:
+  bool WriteHeader() override {
+    std::vector<uint8_t> header;
+    PutU32LE(header, 20000630);  // Сигнатура OpenEXR
+    PutU32LE(header, 2);         // Версия 2, однослойный scanline-файл
+
+    // Каналы в алфавитном порядке, как требует формат
+    Attribute(header, "channels", "chlist", 3 * 18 + 1);
+    for (const char* channel : {"B", "G", "R"}) {
+      PutString(header, channel);
+      PutU32LE(header, 2);  // FLOAT
+      PutU32LE(header, 0);  // pLinear и резерв
+      PutU32LE(header, 1);  // xSampling
+      PutU32LE(header, 1);  // ySampling
+    }
+    header.push_back(0);
+
+    Attribute(header, "compression", "compression", 1);
+    header.push_back(0);  // NO_COMPRESSION
+    for (const char* window : {"dataWindow", "displayWindow"}) {
+      Attribute(header, window, "box2i", 16);
+      PutU32LE(header, 0);
+      PutU32LE(header, 0);
+      PutU32LE(header, width_ - 1);
+      PutU32LE(header, height_ - 1);
+    }
+    Attribute(header, "lineOrder", "lineOrder", 1);
+    header.push_back(0);  // INCREASING_Y: сверху вниз
+    Attribute(header, "pixelAspectRatio", "float", 4);
+    PutFloat(header, 1.0f);
+    Attribute(header, "screenWindowCenter", "v2f", 8);
+    PutFloat(header, 0.0f);
+    PutFloat(header, 0.0f);
+    Attribute(header, "screenWindowWidth", "float", 4);
+    PutFloat(header, 1.0f);
+    header.push_back(0);  // Конец заголовка
+
+    // Без сжатия все строки одного размера, поэтому таблицу смещений
+    // можно записать заранее
+    const uint64_t lineSize = 8 + RowDataSize();
+    const uint64_t first = header.size() + 8ull * height_;
+    for (uint32_t y = 0; y < height_; ++y) {
+      PutU64LE(header, first + lineSize * y);
+    }
+    out_.write(reinterpret_cast<const char*>(header.data()), header.size());
+    return true;
+  }
+
+  void EncodeRow(const uint8_t* bgr) override {
+    // 8-битный цвет хранится в sRGB: возвращаем в линейный
+    row_.resize(width_);
+    DecodeSRGBRow(bgr, row_.data(), width_);
+    EncodeRow(row_.data());
+  }
+
+  void EncodeRow(const vec3* color) override {
+    std::vector<uint8_t> line;
+    line.reserve(8 + RowDataSize());
+    PutU32LE(line, CurrentRow());
+    PutU32LE(line, RowDataSize());
+    for (int channel = 2; channel >= 0; --channel) {  // B, G, R
+      for (uint32_t x = 0; x < width_; ++x) {
+        PutFloat(line, color[x][channel]);
+      }
+    }
+    out_.write(reinterpret_cast<const char*>(line.data()), line.size());
+  }
+
+ private:
+  uint32_t RowDataSize() const { return width_ * 3 * sizeof(float); }
+
+  static void Attribute(std::vector<uint8_t>& out,
+                        const char* name,
+                        const char* type,
+                        uint32_t size) {
+    PutString(out, name);
+    PutString(out, type);
+    PutU32LE(out, size);
+  }
+
+  std::vector<vec3> row_;
+};
+
+}  // namespace
+
+ImageWriter::ImageWriter(std::ofstream stream, uint32_t width, uint32_t height)
+    : out_(std::move(stream)), width_(width), height_(height) {}
+
+std::unique_ptr<ImageWriter> ImageWriter::Open(
+    const std::filesystem::path& path,
+    uint32_t width,
+    uint32_t height) {
+  // Ограничение BMP: высота хранится со знаком
+  if (width == 0 || height == 0 || width > 0x7FFFFFFF / 3 ||
+      height > 0x7FFFFFFF) {
+    std::cerr << "ImageWriter: invalid image size " << width << "x" << height
+              << std::endl;
+    return nullptr;
+  }
+
+  std::string extension = path.extension().string();
+  std::transform(extension.begin(), extension.end(), extension.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  if (extension != ".bmp" && extension != ".ppm" && extension != ".png" &&
+      extension != ".exr") {
+    std::cerr << "ImageWriter: unknown image format " << path << std::endl;
+    return nullptr;
+  }
+
+  std::ofstream stream(path, std::ios_base::binary);
+  if (!stream) {
+    std::cerr << "ImageWriter: cannot open " << path << std::endl;
+    return nullptr;
+  }
+
+  std::unique_ptr<ImageWriter> writer;
+  if (extension == ".bmp") {
+    writer.reset(new BMPWriter(std::move(stream), width, height));
+  } else if (extension == ".ppm") {
+    writer.reset(new PPMWriter(std::move(stream), width, height));
+  } else if (extension == ".png") {
+    writer.reset(new PNGWriter(std::move(stream), width, height));
+  } else {
+    writer.reset(new EXRWriter(std::move(stream), width, height));
+  }
+  if (!writer->WriteHeader() || !writer->out_) {
+    std::cerr << "ImageWriter: failed to write header to " << path << std::endl;
+    return nullptr;
+  }
+  return writer;
+}
+
+bool ImageWriter::AcceptRow() {
+  if (finished_ || rows_ >= height_) {
+    std::cerr << "ImageWriter: too many rows" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool ImageWriter::WriteRow(const uint8_t* bgr) {
+  if (!AcceptRow()) {
+    return false;
+  }
+  EncodeRow(bgr);
+  ++rows_;
+  return static_cast<bool>(out_);
+}
+
+bool ImageWriter::WriteRow(const vec3* color) {
+  if (!AcceptRow()) {
+    return false;
+  }
+  EncodeRow(color);
+  ++rows_;
+  return static_cast<bool>(out_);
+}
+
+void ImageWriter::EncodeRow(const vec3* color) {
+  tonemapped_.assign(color, color + width_);
+  ReinhardTonemapRow(tonemapped_.data(), width_);
+  scratch_.resize(width_ * 3);
+  EncodeSRGBRow(tonemapped_.data(), scratch_.data(), width_);
+  EncodeRow(scratch_.data());
+}
+
+bool ImageWriter::Finish() {
+  if (finished_) {
+    return !out_.fail();
+  }
+  finished_ = true;
+  if (rows_ != height_) {
+    std::cerr << "ImageWriter: only " << rows_ << " of " << height_
+              << " rows written" << std::endl;
+    out_.close();
+    return false;
+  }
+  WriteTrailer();
+  out_.close();
+  return !out_.fail();
+}
+
+bool WriteImage(const RawImage& image, const std::filesystem::path& path) {
+  auto writer = ImageWriter::Open(path, image.GetWidth(), image.GetHeight());
+  if (!writer) {
+    return false;
+  }
+  // Строка 0 в RawImage - нижняя, писатель ждёт строки сверху вниз
+  for (uint32_t y = image.GetHeight(); y-- > 0;) {
+    if (!writer->WriteRow(image.GetRow(y).data())) {
+      return false;
+    }
+  }
+  return writer->Finish();
+}
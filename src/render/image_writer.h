@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <vector>
+#include "math/vec.h"
+
+class RawImage;
+
+// Потоковая запись изображения: заголовок пишется при открытии, строки -
+// по мере готовности, поэтому целиком изображение в памяти не нужно.
+// Строки подаются сверху вниз (от y = height - 1 к y = 0 в координатах
+// камеры и RawImage)
+class ImageWriter {
+ public:
+  virtual ~ImageWriter() = default;
+
+  // Создаёт писатель по расширению файла (.bmp, .ppm, .png, .exr) и пишет
+  // заголовок. При ошибке возвращает nullptr
+  static std::unique_ptr<ImageWriter> Open(const std::filesystem::path& path,
+                                           uint32_t width,
+                                           uint32_t height);
+
+  // Следующая строка в 8-битном BGR (как в RawImage)
+  bool WriteRow(const uint8_t* bgr);
+
+  // Следующая строка в линейном цвете. 8-битные форматы применяют
+  // тонмаппинг и sRGB-кодирование так же, как Renderer
+  bool WriteRow(const vec3* color);
+
+  // Дописывает хвост файла. Возвращает true, если все строки записаны без
+  // ошибок
+  bool Finish();
+
+  uint32_t GetWidth() const { return width_; }
+  uint32_t GetHeight() const { return height_; }
+  uint32_t GetRowsWritten() const { return rows_; }
+
+ protected:
+  ImageWriter(std::ofstream stream, uint32_t width, uint32_t height);
+
+  virtual bool WriteHeader() = 0;
+  virtual void EncodeRow(const uint8_t* bgr) = 0;
+  virtual void EncodeRow(const vec3* color);
+  virtual void WriteTrailer() {}
+
+  // Номер строки, которая сейчас кодируется (0 - верхняя)
+  uint32_t CurrentRow() const { return rows_; }
+
+  std::ofstream out_;
+  uint32_t width_;
+  uint32_t height_;
+
+ private:
+  bool AcceptRow();
+
+  uint32_t rows_ = 0;
+  bool finished_ = false;
+  std::vector<vec3> tonemapped_;  // Строка после тонмаппинга
+  std::vector<uint8_t> scratch_;  // Она же в BGR8
+};
+
+// Записывает готовое изображение через потоковый писатель
+bool WriteImage(const RawImage& image, const std::filesystem::path& path);
@@ -1,9 +1,8 @@
 #include "material_converter.h"
 #include "math/vec_functions.h"
-#include "texture_manager.h"
 
 GPUMaterial MaterialConverter::Convert(const MaterialPBR* mat,
-                                       int textureUnitIndex) {
+                                       int textureLayer) {
   GPUMaterial gpuMat;
   // Значения по умолчанию
   gpuMat.r = 1.0f;
@@ -28,18 +27,9 @@ GPUMaterial MaterialConverter::Convert(const MaterialPBR* mat,
     gpuMat.transmission = mat->getTransmission();
     gpuMat.refraction = mat->getRefraction();
 
-    // Обработка текстуры
-    const std::string& texName = mat->getTextureName();
-    if (!texName.empty()) {
-      Texture* tex = TextureManager::GetInstance().GetTexture(texName);
-      if (tex) {
-        // Активируем соответствующий текстурный слот (Unit)
-        glActiveTexture(GL_TEXTURE0 + textureUnitIndex);
-        // Привязываем саму текстуру к этому слоту
-        tex->bindTexture();
-        // Записываем индекс слота в структуру, чтобы шейдер знал, откуда читать
-        gpuMat.textureID = textureUnitIndex;
-      }
+    // Слой массива текстур, чтобы шейдер знал, откуда читать
+    if (!mat->getTextureName().empty()) {
+      gpuMat.textureID = textureLayer;
     }
   }
   return gpuMat;
@@ -47,8 +37,12 @@ GPUMaterial MaterialConverter::Convert(const MaterialPBR* mat,
 
 void MaterialConverter::InitShaderSamplers(const Shader& shader) {
   shader.use();
-  // Инициализация сэмплеров для текстур шаров
-  for (int i = 0; i < 16; ++i) {
-    shader.setInt("ballTextures[" + std::to_string(i) + "]", i);
-  }
+  // Массив текстур материалов
+  shader.setInt("materialTextures", kMaterialTextureUnit);
+  // Буфер объектов сцены и сетка по нему
+  shader.setInt("objectData", kObjectBufferUnit);
+  shader.setInt("staticData", kStaticBufferUnit);
+  shader.setInt("materialData", kMaterialBufferUnit);
+  shader.setInt("gridCells", kGridCellsUnit);
+  shader.setInt("gridIndices", kGridIndicesUnit);
 }
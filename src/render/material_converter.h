@@ -5,8 +5,9 @@
 
 class MaterialConverter {
  public:
-  // Превращает PBR материал в GPU структуру и биндинг текстуры
-  static GPUMaterial Convert(const MaterialPBR* material, int textureUnitIndex);
+  // Превращает PBR материал в GPU структуру. textureLayer - слой текстуры
+  // материала в массиве materialTextures (-1, если текстуры нет)
+  static GPUMaterial Convert(const MaterialPBR* material, int textureLayer);
 
   // Инициализация сэмплеров в шейдере
   static void InitShaderSamplers(const Shader& shader);
@@ -19,7 +19,7 @@ MaterialPBR::MaterialPBR(const RGB& color,
 float MaterialPBR::D_GGX(float NdotH, float alpha) {
   float a2 = alpha * alpha;
   float denom = (NdotH * NdotH) * (a2 - 1.0f) + 1.0f;
-  return a2 / std::max(M_PI * denom * denom, 1e-6f);
+  return a2 / std::max(float(M_PI) * denom * denom, 1e-6f);
 }
 
 // G_Smith — геометрический фактор (Geometry Function), моделирует взаимное
@@ -34,7 +34,7 @@ float MaterialPBR::G_Smith(float NdotV, float NdotL, float k) {
 
 // Эффект Френеля (при малых углах отражение усиливается)
 vec3 MaterialPBR::FresnelSchlick(float cosTheta, const vec3& F0) {
-  return F0 + (vec3(1.0f, 1.0f, 1.0f) - F0) * pow(1.0f - cosTheta, 5.0f);
+  return F0 + (vec3(1.0f, 1.0f, 1.0f) - F0) * std::pow(1.0f - cosTheta, 5.0f);
 }
 
 RGB MaterialPBR::albedo(const Hit& hit, const Scene&) const {
@@ -121,7 +121,7 @@ vec3 MaterialPBR::shade(const Hit& hit,
         (vec3(1.0f) - F_light) * (1.0f - metallic_) * (1.0f - transmission_);
 
     vec3 radiance = RGBtoVec3(light->getColor()) * brightness;
-    directLighting += (kD * baseColor / M_PI + specular) * radiance * NdotL;
+    directLighting += (kD * baseColor / float(M_PI) + specular) * radiance * NdotL;
   }
 
   // GI: отражение и преломление
@@ -0,0 +1,44 @@
+#include "material_registry.h"
+#include "material_converter.h"
+#include "material_pbr.h"
+#include "texture_manager.h"
+
+int MaterialRegistry::Register(const Material& material) {
+  auto it = indices_.find(&material);
+  if (it != indices_.end()) {
+    return it->second;
+  }
+
+  // Конвертация и поиск слоя текстуры - один раз на материал
+  const MaterialPBR* pbrMat = dynamic_cast<const MaterialPBR*>(&material);
+  int textureLayer = -1;
+  if (pbrMat && !pbrMat->getTextureName().empty()) {
+    textureLayer = TextureManager::GetInstance().AcquireTextureLayer(
+        pbrMat->getTextureName());
+    if (textureLayer >= 0) {
+      texture_layers_.push_back(textureLayer);
+    }
+  }
+
+  int index = static_cast<int>(materials_.size());
+  materials_.push_back(MaterialConverter::Convert(pbrMat, textureLayer));
+  indices_[&material] = index;
+  return index;
+}
+
+void MaterialRegistry::Clear() {
+  // Слои прежних материалов отпускаются только после регистрации новых
+  // (ReleaseRetiredLayers): иначе новая текстура могла бы занять слой,
+  // который тут же понадобится снова
+  ReleaseRetiredLayers();
+  retired_layers_.swap(texture_layers_);
+  indices_.clear();
+  materials_.clear();
+}
+
+void MaterialRegistry::ReleaseRetiredLayers() {
+  for (int layer : retired_layers_) {
+    TextureManager::GetInstance().ReleaseTextureLayer(layer);
+  }
+  retired_layers_.clear();
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <unordered_map>
+#include <vector>
+#include "gpu_data.h"
+#include "material.h"
+
+// Материалы сцены в формате GPU. Каждый материал конвертируется один
+// раз при регистрации и получает постоянный индекс, поэтому данные кадра
+// несут только этот индекс, а таблица материалов загружается в GPU
+// вместе со сценой
+class MaterialRegistry {
+ public:
+  // Индекс материала в таблице; повторная регистрация того же материала
+  // возвращает прежний индекс
+  int Register(const Material& material);
+
+  void Clear();
+
+  // Возвращает TextureManager слои материалов, убранных последним Clear();
+  // слои, на которые больше никто не ссылается, достанутся новым текстурам
+  void ReleaseRetiredLayers();
+
+  const std::vector<GPUMaterial>& GetMaterials() const { return materials_; }
+
+ private:
+  std::unordered_map<const Material*, int> indices_;
+  std::vector<GPUMaterial> materials_;
+  std::vector<int> texture_layers_;  // Слои, взятые у TextureManager
+  std::vector<int> retired_layers_;
+};
@@ -0,0 +1,89 @@
+#include "object_grid.h"
+#include <algorithm>
+#include <cmath>
+
+constexpr int kMaxGridCells = 64;  // Предел ячеек по каждой оси
+
+void ObjectGrid::Build(const std::vector<Item>& items) {
+  cells_.clear();
+  indices_.clear();
+  width_ = 0;
+  height_ = 0;
+  if (items.empty()) {
+    return;
+  }
+
+  // Границы объектов и наибольший из них
+  float minX = items[0].x;
+  float minY = items[0].y;
+  float maxX = minX;
+  float maxY = minY;
+  float maxExtent = 0.0f;
+  for (const Item& item : items) {
+    minX = std::min(minX, item.x - item.extent);
+    minY = std::min(minY, item.y - item.extent);
+    maxX = std::max(maxX, item.x + item.extent);
+    maxY = std::max(maxY, item.y + item.extent);
+    maxExtent = std::max(maxExtent, item.extent);
+  }
+
+  // Запас вокруг ячеек и самой сетки: вне сетки до объектов не ближе margin
+  margin_ = std::max(maxExtent, 1e-3f);
+  minX_ = minX - margin_;
+  minY_ = minY - margin_;
+  float sizeX = maxX - minX + 2.0f * margin_;
+  float sizeY = maxY - minY + 2.0f * margin_;
+
+  // Ячейка порядка диаметра объекта, но не больше kMaxGridCells по оси
+  cellSize_ = std::max(2.0f * maxExtent,
+                       std::max(sizeX, sizeY) / kMaxGridCells);
+  width_ = std::clamp(static_cast<int>(std::ceil(sizeX / cellSize_)), 1,
+                      kMaxGridCells);
+  height_ = std::clamp(static_cast<int>(std::ceil(sizeY / cellSize_)), 1,
+                       kMaxGridCells);
+
+  // Диапазон ячеек, к которым объект подходит ближе margin
+  auto cellRange = [&](const Item& item, int& x0, int& y0, int& x1, int& y1) {
+    float reach = item.extent + margin_;
+    x0 = std::clamp(static_cast<int>((item.x - reach - minX_) / cellSize_), 0,
+                    width_ - 1);
+    y0 = std::clamp(static_cast<int>((item.y - reach - minY_) / cellSize_), 0,
+                    height_ - 1);
+    x1 = std::clamp(static_cast<int>((item.x + reach - minX_) / cellSize_), 0,
+                    width_ - 1);
+    y1 = std::clamp(static_cast<int>((item.y + reach - minY_) / cellSize_), 0,
+                    height_ - 1);
+  };
+
+  // Подсчёт, префиксные суммы и раскладка (сортировка подсчётом)
+  std::vector<int32_t> counts(width_ * height_, 0);
+  for (const Item& item : items) {
+    int x0, y0, x1, y1;
+    cellRange(item, x0, y0, x1, y1);
+    for (int y = y0; y <= y1; ++y) {
+      for (int x = x0; x <= x1; ++x) {
+        ++counts[y * width_ + x];
+      }
+    }
+  }
+
+  cells_.resize(counts.size() * 2);
+  int32_t total = 0;
+  for (size_t cell = 0; cell < counts.size(); ++cell) {
+    cells_[cell * 2] = total;
+    cells_[cell * 2 + 1] = counts[cell];
+    total += counts[cell];
+    counts[cell] = cells_[cell * 2];  // Дальше - позиция записи
+  }
+
+  indices_.resize(total);
+  for (size_t i = 0; i < items.size(); ++i) {
+    int x0, y0, x1, y1;
+    cellRange(items[i], x0, y0, x1, y1);
+    for (int y = y0; y <= y1; ++y) {
+      for (int x = x0; x <= x1; ++x) {
+        indices_[counts[y * width_ + x]++] = static_cast<int32_t>(i);
+      }
+    }
+  }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Равномерная 2D-сетка по плоскости стола (XY) для raymarch-шейдера.
+// Каждая ячейка хранит список объектов, которые подходят к ней ближе, чем
+// margin. Тогда для точки внутри ячейки любой объект вне списка находится
+// не ближе (расстояние до границы ячейки + margin), и шейдер проверяет
+// только объекты своей ячейки
+class ObjectGrid {
+ public:
+  // Объект в плоскости стола: центр и радиус описанного круга
+  struct Item {
+    float x = 0.0f;
+    float y = 0.0f;
+    float extent = 0.0f;
+  };
+
+  // Перестраивает сетку по объектам кадра
+  void Build(const std::vector<Item>& items);
+
+  float GetMinX() const { return minX_; }
+  float GetMinY() const { return minY_; }
+  float GetCellSize() const { return cellSize_; }
+  float GetMargin() const { return margin_; }
+  int GetWidth() const { return width_; }
+  int GetHeight() const { return height_; }
+
+  // Пары (начало, количество) в GetIndices() для каждой ячейки, по строкам
+  const std::vector<int32_t>& GetCells() const { return cells_; }
+
+  // Индексы объектов всех ячеек подряд
+  const std::vector<int32_t>& GetIndices() const { return indices_; }
+
+ private:
+  float minX_ = 0.0f;
+  float minY_ = 0.0f;
+  float cellSize_ = 1.0f;
+  float margin_ = 0.0f;
+  int width_ = 0;
+  int height_ = 0;
+
+  std::vector<int32_t> cells_;
+  std::vector<int32_t> indices_;
+};
@@ -0,0 +1,215 @@
+#include "pixel_kernels.h"
+#include <array>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PIXEL_KERNELS_SSE2 1
+#endif
+
+// SSSE3 (pshufb) не входит в базовый x86-64, поэтому на GCC/Clang
+// перестановки байт собираются отдельно с target("ssse3") и выбираются
+// по процессору при запуске
+#if defined(__SSSE3__) || \
+    (defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)))
+#include <tmmintrin.h>
+#define PIXEL_KERNELS_SSSE3 1
+#if defined(__SSSE3__)
+#define PIXEL_KERNELS_SSSE3_TARGET
+#else
+#define PIXEL_KERNELS_SSSE3_TARGET __attribute__((target("ssse3")))
+#endif
+#endif
+
+// Строки vec3 обрабатываются как плотный массив float
+static_assert(sizeof(vec3) == 3 * sizeof(float), "vec3 must be tightly packed");
+
+namespace {
+
+constexpr int kEncodeSteps = 4096;
+
+const std::array<float, 256>& DecodeTable() {
+  static const std::array<float, 256> table = [] {
+    std::array<float, 256> result{};
+    for (int i = 0; i < 256; ++i) {
+      float c = static_cast<float>(i) / 255.0f;
+      result[i] = c <= 0.04045f ? c / 12.92f
+                                : std::pow((c + 0.055f) / 1.055f, 2.4f);
+    }
+    return result;
+  }();
+  return table;
+}
+
+// Шаг 1/4095 даёт ошибку не больше одной единицы байта на всей кривой
+const std::array<uint8_t, kEncodeSteps>& EncodeTable() {
+  static const std::array<uint8_t, kEncodeSteps> table = [] {
+    std::array<uint8_t, kEncodeSteps> result{};
+    for (int i = 0; i < kEncodeSteps; ++i) {
+      float v = static_cast<float>(i) / (kEncodeSteps - 1);
+      float s = v <= 0.0031308f ? v * 12.92f
+                                : 1.055f * std::pow(v, 1.0f / 2.4f) - 0.055f;
+      result[i] = static_cast<uint8_t>(std::lround(s * 255.0f));
+    }
+    return result;
+  }();
+  return table;
+}
+
+#if PIXEL_KERNELS_SSSE3
+bool HasSSSE3() {
+#if defined(__SSSE3__)
+  return true;
+#else
+  static const bool supported = __builtin_cpu_supports("ssse3");
+  return supported;
+#endif
+}
+
+// Обрабатывают начало строки и возвращают число готовых пикселей;
+// остаток - скалярной веткой
+PIXEL_KERNELS_SSSE3_TARGET size_t BGRToRGBARowSSSE3(const uint8_t* bgr,
+                                                    uint8_t* rgba,
+                                                    size_t count) {
+  // 4 пикселя за раз; загрузка 16 байт захватывает 4 лишних, поэтому
+  // последние пиксели идут скалярной веткой
+  const __m128i shuffle =
+      _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+  const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+  size_t i = 0;
+  for (; 3 * i + 16 <= 3 * count; i += 4) {
+    __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(bgr + 3 * i));
+    v = _mm_or_si128(_mm_shuffle_epi8(v, shuffle), alpha);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(rgba + 4 * i), v);
+  }
+  return i;
+}
+
+PIXEL_KERNELS_SSSE3_TARGET size_t SwapRedBlueRowSSSE3(const uint8_t* src,
+                                                      uint8_t* dst,
+                                                      size_t count) {
+  // 5 пикселей (15 байт) за раз; 16-й байт копируется как есть и
+  // перезаписывается следующей итерацией
+  const __m128i shuffle =
+      _mm_setr_epi8(2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 14, 13, 12, 15);
+  size_t i = 0;
+  for (; 3 * i + 16 <= 3 * count; i += 5) {
+    __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 3 * i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 3 * i),
+                     _mm_shuffle_epi8(v, shuffle));
+  }
+  return i;
+}
+#endif
+
+}  // namespace
+
+const float* SRGBToLinearTable() {
+  return DecodeTable().data();
+}
+
+uint8_t LinearToSRGB8(float value) {
+  // NaN и отрицательные значения - в ноль, как у SIMD-ветки
+  if (!(value > 0.0f)) {
+    return EncodeTable()[0];
+  }
+  if (value >= 1.0f) {
+    return EncodeTable()[kEncodeSteps - 1];
+  }
+  int index = static_cast<int>(value * (kEncodeSteps - 1) + 0.5f);
+  return EncodeTable()[index];
+}
+
+void ReinhardTonemapRow(vec3* colors, size_t count) {
+  float* data = reinterpret_cast<float*>(colors);
+  size_t total = count * 3;
+  size_t i = 0;
+#if PIXEL_KERNELS_SSE2
+  const __m128 one = _mm_set1_ps(1.0f);
+  for (; i + 4 <= total; i += 4) {
+    __m128 v = _mm_loadu_ps(data + i);
+    _mm_storeu_ps(data + i, _mm_div_ps(v, _mm_add_ps(v, one)));
+  }
+#endif
+  for (; i < total; ++i) {
+    data[i] = data[i] / (data[i] + 1.0f);
+  }
+}
+
+void EncodeSRGBRow(const vec3* colors, uint8_t* bgr, size_t count) {
+  const float* src = reinterpret_cast<const float*>(colors);
+  size_t i = 0;
+#if PIXEL_KERNELS_SSE2
+  // Зажатие и перевод в индексы таблицы - по 4 пикселя (12 каналов);
+  // сама выборка из таблицы скалярная
+  const uint8_t* table = EncodeTable().data();
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 scale = _mm_set1_ps(kEncodeSteps - 1);
+  const __m128 half = _mm_set1_ps(0.5f);
+  alignas(16) int32_t index[12];
+  for (; i + 4 <= count; i += 4) {
+    for (int k = 0; k < 3; ++k) {
+      __m128 v = _mm_loadu_ps(src + 3 * i + 4 * k);
+      v = _mm_min_ps(_mm_max_ps(v, zero), one);  // max(NaN, 0) = 0
+      __m128i n = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, scale), half));
+      _mm_store_si128(reinterpret_cast<__m128i*>(index + 4 * k), n);
+    }
+    uint8_t* out = bgr + 3 * i;
+    for (int p = 0; p < 4; ++p) {
+      out[3 * p + 0] = table[index[3 * p + 2]];
+      out[3 * p + 1] = table[index[3 * p + 1]];
+      out[3 * p + 2] = table[index[3 * p + 0]];
+    }
+  }
+#endif
+  for (; i < count; ++i) {
+    bgr[3 * i + 0] = LinearToSRGB8(src[3 * i + 2]);
+    bgr[3 * i + 1] = LinearToSRGB8(src[3 * i + 1]);
+    bgr[3 * i + 2] = LinearToSRGB8(src[3 * i + 0]);
+  }
+}
+
+void DecodeSRGBRow(const uint8_t* bgr, vec3* colors, size_t count) {
+  // Без gather-инструкций SSE2 здесь не помогает: только таблица
+  const float* table = DecodeTable().data();
+  float* dst = reinterpret_cast<float*>(colors);
+  for (size_t i = 0; i < count; ++i) {
+    dst[3 * i + 0] = table[bgr[3 * i + 2]];
+    dst[3 * i + 1] = table[bgr[3 * i + 1]];
+    dst[3 * i + 2] = table[bgr[3 * i + 0]];
+  }
+}
+
+void BGRToRGBARow(const uint8_t* bgr, uint8_t* rgba, size_t count) {
+  size_t i = 0;
+#if PIXEL_KERNELS_SSSE3
+  if (HasSSSE3()) {
+    i = BGRToRGBARowSSSE3(bgr, rgba, count);
+  }
+#endif
+  for (; i < count; ++i) {
+    rgba[4 * i + 0] = bgr[3 * i + 2];
+    rgba[4 * i + 1] = bgr[3 * i + 1];
+    rgba[4 * i + 2] = bgr[3 * i + 0];
+    rgba[4 * i + 3] = 255;
+  }
+}
+
+void SwapRedBlueRow(const uint8_t* src, uint8_t* dst, size_t count) {
+  size_t i = 0;
+#if PIXEL_KERNELS_SSSE3
+  if (HasSSSE3()) {
+    i = SwapRedBlueRowSSSE3(src, dst, count);
+  }
+#endif
+  for (; i < count; ++i) {
+    uint8_t first = src[3 * i + 0];
+    dst[3 * i + 1] = src[3 * i + 1];
+    dst[3 * i + 0] = src[3 * i + 2];
+    dst[3 * i + 2] = first;
+  }
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "math/vec.h"
+
+// Пакетные преобразования строк пикселей. На x86 используются SSE2, а
+// перестановки байт - SSSE3 (на GCC/Clang выбирается при запуске, если
+// процессор его поддерживает), иначе - скалярные циклы с тем же
+// результатом. Буферы не должны перекрываться, если не сказано иное
+
+// Таблица sRGB -> линейный цвет на 256 значений
+const float* SRGBToLinearTable();
+
+// Линейное значение [0, 1] -> sRGB-байт по таблице на 4096 ступеней
+uint8_t LinearToSRGB8(float value);
+
+// Тонмаппинг Reinhard c / (c + 1) на месте
+void ReinhardTonemapRow(vec3* colors, size_t count);
+
+// Линейный RGB -> BGR8 с sRGB-кодированием (значения зажимаются в [0, 1])
+void EncodeSRGBRow(const vec3* colors, uint8_t* bgr, size_t count);
+
+// BGR8 в sRGB -> линейный RGB
+void DecodeSRGBRow(const uint8_t* bgr, vec3* colors, size_t count);
+
+// BGR8 -> RGBA8 с непрозрачной альфой
+void BGRToRGBARow(const uint8_t* bgr, uint8_t* rgba, size_t count);
+
+// BGR8 <-> RGB8: меняет местами первый и третий байт пикселя
+void SwapRedBlueRow(const uint8_t* src, uint8_t* dst, size_t count);
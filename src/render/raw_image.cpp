@@ -1,46 +1,88 @@
 #include "raw_image.h"
-#include <fstream>
-#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include "bmp/bmp_view.h"
 
-// Загрузка BMP-файла с использованием структур из bmp.h
+// Загрузка BMP-файла через отображение в память
 RawImage loadFromBMP(const std::string& filename) {
-  std::ifstream file(filename, std::ios::binary);
-  if (!file) {
-    std::cerr << "Failed to open BMP file: " << filename << std::endl;
+  BMPView view;
+  if (!view.Open(filename)) {
     return RawImage(0, 0);
   }
 
-  // Чтение заголовка BMP (bfi и cfi из bmp.h)
-  bmpInfo info;
-  file.read(reinterpret_cast<char*>(&info), sizeof(bmpInfo));
-  if (info.fileInfo.fSignature != 19778) {  // Проверка сигнатуры 'BM'
-    std::cerr << "Invalid BMP signature" << std::endl;
-    file.close();
-    return RawImage(0, 0);
+  // Строки копируются из отображения сразу в буфер изображения
+  RawImage image(view.GetWidth(), view.GetHeight());
+  if (const uint8_t* pixels = view.GetPixels()) {
+    std::memcpy(image.raw_data(), pixels, image.raw_size());
+  } else {
+    for (uint32_t y = 0; y < view.GetHeight(); ++y) {
+      std::memcpy(image.raw_data() + view.GetStride() * y, view.GetRow(y),
+                  view.GetStride());
+    }
   }
+  return image;
+}
 
-  // Создание объекта RawImage с нужными размерами
-  RawImage image(info.imageInfo.fWidth, info.imageInfo.fHeight);
-  uint32_t line_bytes = ((image.GetWidth() * 24 + 31) / 32) * 4;
+bool readBMPSize(const std::string& filename,
+                 uint32_t& width,
+                 uint32_t& height) {
+  // Отображение читает с диска только страницу заголовка
+  BMPView view;
+  if (!view.Open(filename)) {
+    return false;
+  }
+  width = view.GetWidth();
+  height = view.GetHeight();
+  return true;
+}
 
-  // Чтение пиксельных данных
-  file.seekg(info.fileInfo.fDataOffset);
-  file.read(reinterpret_cast<char*>(const_cast<uint8_t*>(image.raw_data())),
-            line_bytes * image.GetHeight());
-  file.close();
-  return image;
+RawImage resampleImage(const RawImage& image, uint32_t width, uint32_t height) {
+  RawImage result(width, height);
+  float scaleX = static_cast<float>(image.GetWidth()) / width;
+  float scaleY = static_cast<float>(image.GetHeight()) / height;
+  uint32_t maxX = image.GetWidth() - 1;
+  uint32_t maxY = image.GetHeight() - 1;
+
+  for (uint32_t y = 0; y < height; ++y) {
+    float sy = std::max((y + 0.5f) * scaleY - 0.5f, 0.0f);
+    uint32_t y0 = std::min(static_cast<uint32_t>(sy), maxY);
+    uint32_t y1 = std::min(y0 + 1, maxY);
+    float fy = sy - y0;
+    for (uint32_t x = 0; x < width; ++x) {
+      float sx = std::max((x + 0.5f) * scaleX - 0.5f, 0.0f);
+      uint32_t x0 = std::min(static_cast<uint32_t>(sx), maxX);
+      uint32_t x1 = std::min(x0 + 1, maxX);
+      float fx = sx - x0;
+
+      RGB c00 = image.GetPixel(x0, y0);
+      RGB c10 = image.GetPixel(x1, y0);
+      RGB c01 = image.GetPixel(x0, y1);
+      RGB c11 = image.GetPixel(x1, y1);
+      auto mix = [&](uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+        float top = a + (b - a) * fx;
+        float bottom = c + (d - c) * fx;
+        return static_cast<uint8_t>(top + (bottom - top) * fy + 0.5f);
+      };
+      result.SetPixel(x, y,
+                      RGB{mix(c00.r, c10.r, c01.r, c11.r),
+                          mix(c00.g, c10.g, c01.g, c11.g),
+                          mix(c00.b, c10.b, c01.b, c11.b)});
+    }
+  }
+  return result;
 }
 
 RawImage::RawImage(uint32_t width, uint32_t height)
     : width_(width),
       height_(height),
-      raw_data_(((width * 24 + 31) / 32) * 4 * height, 125) {}
+      stride_(((width * 24 + 31) / 32) * 4),
+      raw_data_(stride_ * height, 125) {}
 
 void RawImage::SetPixel(uint32_t x, uint32_t y, const RGB& color) {
-  const uint32_t line_bytes = ((width_ * 24 + 31) / 32) * 4;
-  raw_data_[sizeof(RGB) * x + line_bytes * y + 0] = color.b;
-  raw_data_[sizeof(RGB) * x + line_bytes * y + 1] = color.g;
-  raw_data_[sizeof(RGB) * x + line_bytes * y + 2] = color.r;
+  size_t idx = sizeof(RGB) * x + stride_ * y;
+  raw_data_[idx + 0] = color.b;
+  raw_data_[idx + 1] = color.g;
+  raw_data_[idx + 2] = color.r;
 }
 
 RGB RawImage::GetPixel(uint32_t x, uint32_t y) const {
@@ -49,8 +91,7 @@ RGB RawImage::GetPixel(uint32_t x, uint32_t y) const {
     return RGB{0, 0, 0};
   }
 
-  const uint32_t line_bytes = ((width_ * 24 + 31) / 32) * 4;
-  uint32_t idx = sizeof(RGB) * x + line_bytes * y;
+  size_t idx = sizeof(RGB) * x + stride_ * y;
 
   uint8_t b = raw_data_[idx + 0];
   uint8_t g = raw_data_[idx + 1];
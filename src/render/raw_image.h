@@ -1,5 +1,6 @@
 #pragma once
 
+#include <span>
 #include <string>
 #include <vector>
 #include "RGB.h"
@@ -8,6 +9,15 @@
 // Загружает данные изображения из BMP-файла, используя структуры из bmp.h
 RawImage loadFromBMP(const std::string& filename);
 
+// Читает только заголовок BMP-файла. Возвращает false, если файл не
+// открылся или не прошёл проверку
+bool readBMPSize(const std::string& filename,
+                 uint32_t& width,
+                 uint32_t& height);
+
+// Билинейно масштабирует изображение до width x height
+RawImage resampleImage(const RawImage& image, uint32_t width, uint32_t height);
+
 class RawImage {
  public:
   RawImage(uint32_t width, uint32_t height);
@@ -23,6 +33,22 @@ class RawImage {
 
   // Возвращает указатель на сырые данные изображения
   const uint8_t* raw_data() const { return raw_data_.data(); }
+  uint8_t* raw_data() { return raw_data_.data(); }
+
+  // Размер сырых данных в байтах (строки выровнены по 4 байта)
+  size_t raw_size() const { return raw_data_.size(); }
+
+  // Байты между началами соседних строк
+  size_t GetStride() const { return stride_; }
+
+  // Пиксели строки y (0 - нижняя) в BGR, без выравнивания в конце.
+  // Для пакетной обработки строк (pixel_kernels.h)
+  std::span<uint8_t> GetRow(uint32_t y) {
+    return {raw_data_.data() + stride_ * y, size_t(width_) * 3};
+  }
+  std::span<const uint8_t> GetRow(uint32_t y) const {
+    return {raw_data_.data() + stride_ * y, size_t(width_) * 3};
+  }
 
   // Возвращает цвет пикселя по координатам (x, y)
   RGB GetPixel(uint32_t x, uint32_t y) const;
@@ -30,5 +56,6 @@ class RawImage {
  private:
   uint32_t width_;                 // Ширина изображения
   uint32_t height_;                // Высота изображения
+  size_t stride_;                  // Длина строки с выравниванием
   std::vector<uint8_t> raw_data_;  // Буфер для хранения пиксельных данных (BGR)
 };
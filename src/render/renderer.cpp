@@ -1,17 +1,63 @@
 #include "renderer.h"
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include "core/job_system.h"
+#include "image_writer.h"
 #include "math/vec_functions.h"
+#include "pixel_kernels.h"
 
 void Renderer::Render(const Camera& camera,
                       const Scene& scene,
                       RawImage& out_image) {
-  for (uint32_t x = 0; x < out_image.GetWidth(); ++x) {
-    for (uint32_t y = 0; y < out_image.GetHeight(); ++y) {
+  // Цвета строки собираются в буфер и переводятся в BGR8 одним вызовом
+  std::vector<vec3> colors(out_image.GetWidth());
+  for (uint32_t y = 0; y < out_image.GetHeight(); ++y) {
+    for (uint32_t x = 0; x < out_image.GetWidth(); ++x) {
       auto [imgx, imgy, ray] = camera.GetRay(x, y);
+      colors[imgx] = scene.CastRay(ray, 0);
+    }
+    ReinhardTonemapRow(colors.data(), colors.size());
+    EncodeSRGBRow(colors.data(), out_image.GetRow(y).data(), colors.size());
+  }
+}
+
+bool Renderer::RenderToStream(const Camera& camera,
+                              const Scene& scene,
+                              ImageWriter& writer,
+                              uint32_t bandHeight) {
+  const uint32_t width = writer.GetWidth();
+  const uint32_t height = writer.GetHeight();
+  if (static_cast<int>(width) != camera.GetWidth() ||
+      static_cast<int>(height) != camera.GetHeight()) {
+    std::cerr << "Renderer: frame size " << width << "x" << height
+              << " does not match the camera" << std::endl;
+    return false;
+  }
+
+  bandHeight = std::clamp<uint32_t>(bandHeight, 1, height);
+  std::vector<vec3> band(size_t(width) * bandHeight);
 
-      vec3 finalColor = scene.CastRay(ray, 0);
+  // Писатель ждёт строки сверху вниз, а y = 0 у камеры - нижняя строка
+  for (uint32_t top = 0; top < height; top += bandHeight) {
+    const uint32_t rows = std::min(bandHeight, height - top);
+    JobSystem::GetInstance().ParallelFor(
+        rows, 1, [&](size_t begin, size_t end, size_t) {
+          for (size_t row = begin; row < end; ++row) {
+            const uint32_t y = height - 1 - (top + static_cast<uint32_t>(row));
+            vec3* colors = band.data() + row * width;
+            for (uint32_t x = 0; x < width; ++x) {
+              colors[x] = scene.CastRay(std::get<2>(camera.GetRay(x, y)), 0);
+            }
+          }
+        });
 
-      RGB outRGB = Vec3toRGB(applyGamma(reinhardTonemap(finalColor)));
-      out_image.SetPixel(imgx, imgy, outRGB);
+    for (uint32_t row = 0; row < rows; ++row) {
+      if (!writer.WriteRow(band.data() + size_t(row) * width)) {
+        return false;
+      }
     }
   }
+  return writer.Finish();
 }
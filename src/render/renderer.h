@@ -5,9 +5,19 @@
 #include "ray.h"
 #include "scene.h"
 
+class ImageWriter;
+
 class Renderer {
  public:
   void Render(const Camera& camera, const Scene& scene, RawImage& out_image);
 
+  // Рендерит кадр полосами по bandHeight строк (строки полосы - параллельно)
+  // и сразу отдаёт их писателю, так что в памяти живёт только одна полоса.
+  // Размер кадра берётся из писателя и должен совпадать с камерой
+  bool RenderToStream(const Camera& camera,
+                      const Scene& scene,
+                      ImageWriter& writer,
+                      uint32_t bandHeight = 32);
+
  private:
 };
@@ -1,4 +1,5 @@
 #include "scene.h"
+#include <algorithm>
 #include "physics/physics_engine.h"
 
 Scene::Scene() {
@@ -12,6 +13,10 @@ Scene& Scene::operator=(Scene&&) = default;
 
 void Scene::AddEntity(std::unique_ptr<SceneEntity> entity) {
   entities_.push_back(std::move(entity));
+  // Событийная модель собирается заново уже с новым телом
+  if (physics_engine_) {
+    physics_engine_->ResetEventSimulation();
+  }
 }
 
 void Scene::AddLight(std::unique_ptr<LightSource> light) {
@@ -19,19 +24,60 @@ void Scene::AddLight(std::unique_ptr<LightSource> light) {
 }
 
 void Scene::UpdatePhysics(float deltaTime) {
+  StepPhysics(deltaTime);
+  SyncRenderState();
+}
+
+void Scene::StepPhysics(float deltaTime) {
   // Обработка столкновений
   if (physics_engine_) {
     physics_engine_->Update(*this, deltaTime);
   }
+}
 
+void Scene::SyncRenderState() {
   // Синхронизация позиций графических объектов с физическими телами
   for (auto& entity : entities_) {
     if (entity->body && entity->object) {
       entity->object->SetRenderPosition(entity->body->GetPosition());
+      entity->object->SetRenderOrientation(entity->body->orientation);
+    }
+  }
+}
+
+void Scene::CaptureSnapshot(PhysicsSnapshot& snapshot) const {
+  snapshot.transforms.resize(entities_.size());
+  for (size_t i = 0; i < entities_.size(); ++i) {
+    if (entities_[i]->body) {
+      snapshot.transforms[i].position = entities_[i]->body->GetPosition();
+      snapshot.transforms[i].orientation = entities_[i]->body->orientation;
+    }
+  }
+}
+
+void Scene::ApplySnapshot(const PhysicsSnapshot& previous,
+                          const PhysicsSnapshot& current,
+                          float alpha) {
+  // Снимки могли быть сделаны до загрузки всех сущностей
+  size_t count = std::min({entities_.size(), previous.transforms.size(),
+                           current.transforms.size()});
+  for (size_t i = 0; i < count; ++i) {
+    auto& entity = entities_[i];
+    if (!entity->body || !entity->object) {
+      continue;
     }
+    const BodyTransform& from = previous.transforms[i];
+    const BodyTransform& to = current.transforms[i];
+    entity->object->SetRenderPosition(mix(from.position, to.position, alpha));
+    entity->object->SetRenderOrientation(
+        slerp(from.orientation, to.orientation, alpha));
   }
 }
 
+PhysicsEngine& Scene::GetPhysicsEngine() {
+  return *physics_engine_;
+}
+
 const std::vector<std::unique_ptr<SceneEntity>>& Scene::GetEntities() const {
   return entities_;
 }
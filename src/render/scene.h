@@ -8,6 +8,7 @@
 #include "light_source.h"
 #include "math/vec.h"
 #include "math/vec_functions.h"
+#include "physics/physics_snapshot.h"
 #include "ray.h"
 #include "scene_entity.h"
 #include "scene_object.h"
@@ -36,6 +37,23 @@ class Scene {
   void AddEntity(std::unique_ptr<SceneEntity> entity);
   void AddLight(std::unique_ptr<LightSource> light);
   void UpdatePhysics(float deltaTime);
+
+  // Шаг физики без обновления графических объектов
+  void StepPhysics(float deltaTime);
+
+  // Копирует положения тел в графические объекты
+  void SyncRenderState();
+
+  // Снимок положений тел после шага (без модельного времени)
+  void CaptureSnapshot(PhysicsSnapshot& snapshot) const;
+
+  // Выставляет графическим объектам положения, интерполированные между
+  // двумя снимками: alpha = 0 - previous, alpha = 1 - current
+  void ApplySnapshot(const PhysicsSnapshot& previous,
+                     const PhysicsSnapshot& current,
+                     float alpha);
+
+  PhysicsEngine& GetPhysicsEngine();
   const std::vector<std::unique_ptr<SceneEntity>>& GetEntities() const;
   const std::vector<std::unique_ptr<LightSource>>& GetLights() const;
   vec3 CastRay(const Ray& ray, int depth) const;
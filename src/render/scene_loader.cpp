@@ -1,5 +1,7 @@
 #include "scene_loader.h"
 #include <fstream>
+#include "core/job_system.h"
+#include "physics/physics_engine.h"
 
 using json = nlohmann::json;
 
@@ -66,6 +68,25 @@ SceneLoader SceneLoader::Load(const std::string& jsonPath) {
       scene.AddLight(LightParser::Parse(l));
     }
   }
+  if (resolved.contains("physics")) {
+    const auto& physicsNode = resolved["physics"];
+    PhysicsEngine& engine = scene.GetPhysicsEngine();
+    if (physicsNode.contains("integrator")) {
+      engine.integrator =
+          ParseIntegratorType(physicsNode["integrator"].get<std::string>());
+    }
+    if (physicsNode.contains("solver_iterations")) {
+      engine.solverIterations = physicsNode["solver_iterations"].get<int>();
+    }
+    if (physicsNode.contains("threads")) {
+      // 0 - по числу ядер
+      JobSystem::GetInstance().SetThreadCount(
+          physicsNode["threads"].get<size_t>());
+    }
+    if (physicsNode.contains("mode")) {
+      engine.mode = ParseSimulationMode(physicsNode["mode"].get<std::string>());
+    }
+  }
   if (resolved.contains("objects")) {
     const auto& objectsNode = resolved["objects"];
 
@@ -15,6 +15,7 @@ struct CollisionManifold {
   vec3 normal{0.0f};        // Нормаль столкновения
   float depth = 0.0f;       // Глубина проникновения
   vec3 contactPoint{0.0f};  // Точка контакта
+  int featureId = 0;        // Элемент геометрии контакта (для кэша контактов)
 };
 
 class SceneObject {
@@ -27,6 +28,8 @@ class SceneObject {
   virtual void UpdateUniforms(Shader& shader) const;
   virtual void SetRenderPosition(const vec3& position) = 0;
   virtual vec3 GetRenderPosition() const = 0;
+  virtual void SetRenderOrientation(const quat& orientation) = 0;
+  virtual quat GetRenderOrientation() const = 0;
 
   // Метод для вычисления столкновения с другим объектом
   virtual CollisionManifold ComputeCollision(
@@ -41,6 +41,14 @@ vec3 Box::GetRenderPosition() const {
   return GetPosition();
 }
 
+void Box::SetRenderOrientation(const quat& orientation) {
+  SetOrientation(orientation);
+}
+
+quat Box::GetRenderOrientation() const {
+  return GetOrientation();
+}
+
 vec3 Box::GetHalfExtents() const {
   return vertex_;
 }
@@ -95,6 +103,20 @@ CollisionManifold Box::ComputeCollisionWith(
     // Нормаль должна указывать от Box к Sphere
     result.normal = MulMatVec(boxRot, normalLocal);
     result.contactPoint = boxPos + MulMatVec(boxRot, closestPointLocal);
+
+    // Элемент коробки (грань/ребро/вершина): по каждой оси 0 - внутри,
+    // 1 - прижат к минусу, 2 - прижат к плюсу
+    int feature = 0;
+    for (int axis = 2; axis >= 0; --axis) {
+      int region = 0;
+      if (localSpherePos[axis] < -boxHalfExtents[axis]) {
+        region = 1;
+      } else if (localSpherePos[axis] > boxHalfExtents[axis]) {
+        region = 2;
+      }
+      feature = feature * 3 + region;
+    }
+    result.featureId = feature;
   }
   return result;
 }
@@ -30,6 +30,14 @@ vec3 Sphere::GetRenderPosition() const {
   return GetPosition();
 }
 
+void Sphere::SetRenderOrientation(const quat& orientation) {
+  SetOrientation(orientation);
+}
+
+quat Sphere::GetRenderOrientation() const {
+  return GetOrientation();
+}
+
 float Sphere::GetRadius() const {
   return radius_;
 }
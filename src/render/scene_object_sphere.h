@@ -2,7 +2,9 @@
 #include "control/property.h"
 #include "scene_object.h"
 
-class Sphere : public SceneObject, public PositionProperty {
+class Sphere : public SceneObject,
+               public PositionProperty,
+               public OrientationProperty {
  public:
   Sphere(const vec3& position, float r, std::unique_ptr<Material> mat);
 
@@ -12,6 +14,8 @@ class Sphere : public SceneObject, public PositionProperty {
   void UpdateUniforms(Shader& shader) const override;
   void SetRenderPosition(const vec3& position) override;
   vec3 GetRenderPosition() const override;
+  void SetRenderOrientation(const quat& orientation) override;
+  quat GetRenderOrientation() const override;
 
   float GetRadius() const;
 
@@ -51,8 +51,10 @@ void Texture::createTexture() {
   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, image_.GetWidth(), image_.GetHeight(),
                0, GL_BGR, GL_UNSIGNED_BYTE, image_.raw_data());
 
-  // Настройка фильтрации
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  // Настройка фильтрации: мип-уровни убирают мерцание при уменьшении
+  glGenerateMipmap(GL_TEXTURE_2D);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                  GL_LINEAR_MIPMAP_LINEAR);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
   // Настройка обрезки по краям
@@ -84,6 +86,7 @@ void Texture::updateTexture(const RawImage& image) {
     glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, image.GetWidth(), image.GetHeight(),
                     GL_BGR, GL_UNSIGNED_BYTE, image.raw_data());
   }
+  glGenerateMipmap(GL_TEXTURE_2D);  // Мип-уровни по новым данным
 
   glBindTexture(GL_TEXTURE_2D, 0);
 }
@@ -0,0 +1,187 @@
+#include "texture_array.h"
+#include <algorithm>
+#include <vector>
+#include "block_compression.h"
+#include "gl/gl_extensions.h"
+
+// GL_EXT_texture_filter_anisotropic (ядро GL 4.6)
+#ifndef GL_TEXTURE_MAX_ANISOTROPY
+#define GL_TEXTURE_MAX_ANISOTROPY 0x84FE
+#define GL_MAX_TEXTURE_MAX_ANISOTROPY 0x84FF
+#endif
+
+// GL_EXT_texture_compression_s3tc и GL_ARB_texture_compression_bptc
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#endif
+
+GLenum GetInternalFormat(TexturePackFormat format) {
+  switch (format) {
+    case TexturePackFormat::BC1:
+      return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    case TexturePackFormat::BC3:
+      return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    case TexturePackFormat::BC7:
+      return GL_COMPRESSED_RGBA_BPTC_UNORM;
+    default:
+      return GL_RGB8;
+  }
+}
+
+bool IsTextureFormatSupported(TexturePackFormat format) {
+  const GLExtensions& ext = GLExtensions::GetInstance();
+  switch (format) {
+    case TexturePackFormat::BC1:
+    case TexturePackFormat::BC3:
+      return ext.Has("GL_EXT_texture_compression_s3tc");
+    case TexturePackFormat::BC7:
+      return ext.Has("GL_ARB_texture_compression_bptc");
+    default:
+      return true;
+  }
+}
+
+// Серая заглушка одного мип-уровня для count слоёв
+static std::vector<uint8_t> Placeholder(TexturePackFormat format,
+                                        uint32_t width,
+                                        uint32_t height,
+                                        int level,
+                                        int count) {
+  size_t size = MipLevelSize(format, width, height, level) * count;
+  if (format == TexturePackFormat::BGR8) {
+    return std::vector<uint8_t>(size, 128);
+  }
+
+  // Все блоки сжатой заглушки одинаковы
+  uint8_t rgba[64];
+  std::fill(rgba, rgba + 64, 128);
+  for (int i = 0; i < 16; ++i) {
+    rgba[i * 4 + 3] = 255;
+  }
+  uint8_t block[16];
+  size_t blockBytes = format == TexturePackFormat::BC1 ? 8 : 16;
+  if (format == TexturePackFormat::BC1) {
+    EncodeBC1Block(rgba, block);
+  } else if (format == TexturePackFormat::BC3) {
+    EncodeBC3Block(rgba, block);
+  } else {
+    EncodeBC7Block(rgba, block);
+  }
+  std::vector<uint8_t> data(size);
+  for (size_t offset = 0; offset < size; offset += blockBytes) {
+    std::copy(block, block + blockBytes, data.begin() + offset);
+  }
+  return data;
+}
+
+TextureArray::~TextureArray() {
+  Release();
+}
+
+void TextureArray::Allocate(uint32_t width,
+                            uint32_t height,
+                            int layers,
+                            TexturePackFormat format) {
+  Release();
+  if (width == 0 || height == 0 || layers <= 0) {
+    return;
+  }
+  width_ = width;
+  height_ = height;
+  layerCount_ = layers;
+  levelCount_ = static_cast<int>(MipLevelCount(width, height));
+  format_ = format;
+
+  glGenTextures(1, &textureID_);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, textureID_);
+
+  // Все слои и мип-уровни сразу заполняются заглушкой, пока не загружены
+  // настоящие текстуры
+  for (int level = 0; level < levelCount_; ++level) {
+    GLsizei w = std::max<GLsizei>(width >> level, 1);
+    GLsizei h = std::max<GLsizei>(height >> level, 1);
+    std::vector<uint8_t> placeholder =
+        Placeholder(format_, width, height, level, layerCount_);
+    if (format_ == TexturePackFormat::BGR8) {
+      glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGB8, w, h, layerCount_, 0,
+                   GL_BGR, GL_UNSIGNED_BYTE, placeholder.data());
+    } else {
+      glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, level,
+                             GetInternalFormat(format_), w, h, layerCount_, 0,
+                             static_cast<GLsizei>(placeholder.size()),
+                             placeholder.data());
+    }
+  }
+
+  // Мип-уровни убирают мерцание номеров на удалённых шарах
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER,
+                  GL_LINEAR_MIPMAP_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+  // Анизотропия - если драйвер её поддерживает
+  const GLExtensions& ext = GLExtensions::GetInstance();
+  if (ext.Has("GL_EXT_texture_filter_anisotropic") ||
+      ext.Has("GL_ARB_texture_filter_anisotropic")) {
+    GLfloat maxAnisotropy = 1.0f;
+    glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY, &maxAnisotropy);
+    glTexParameterf(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_ANISOTROPY,
+                    std::min(maxAnisotropy, 8.0f));
+  }
+
+  glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+void TextureArray::UploadLayer(int layer,
+                               const void* pixels,
+                               int level,
+                               GLenum pixelFormat) {
+  if (textureID_ == 0 || layer < 0 || layer >= layerCount_) {
+    return;
+  }
+  GLsizei w = std::max<GLsizei>(width_ >> level, 1);
+  GLsizei h = std::max<GLsizei>(height_ >> level, 1);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, textureID_);
+  if (format_ == TexturePackFormat::BGR8) {
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, w, h, 1,
+                    pixelFormat, GL_UNSIGNED_BYTE, pixels);
+  } else {
+    GLsizei size = static_cast<GLsizei>(
+        MipLevelSize(format_, width_, height_, static_cast<uint32_t>(level)));
+    glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, w, h, 1,
+                              GetInternalFormat(format_), size, pixels);
+  }
+  glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+void TextureArray::UploadPlaceholder(int layer) {
+  if (textureID_ == 0 || layer < 0 || layer >= layerCount_) {
+    return;
+  }
+  for (int level = 0; level < levelCount_; ++level) {
+    std::vector<uint8_t> placeholder =
+        Placeholder(format_, width_, height_, level, 1);
+    UploadLayer(layer, placeholder.data(), level);
+  }
+}
+
+void TextureArray::Bind() const {
+  glBindTexture(GL_TEXTURE_2D_ARRAY, textureID_);
+}
+
+void TextureArray::Release() {
+  if (textureID_ != 0) {
+    glDeleteTextures(1, &textureID_);
+  }
+  textureID_ = 0;
+  width_ = 0;
+  height_ = 0;
+  layerCount_ = 0;
+  levelCount_ = 0;
+  format_ = TexturePackFormat::BGR8;
+}
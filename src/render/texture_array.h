@@ -0,0 +1,64 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstdint>
+#include "texture_pack.h"
+
+// Внутренний формат GL для формата пакета текстур
+GLenum GetInternalFormat(TexturePackFormat format);
+
+// Поддерживает ли драйвер формат (несжатый поддерживается всегда)
+bool IsTextureFormatSupported(TexturePackFormat format);
+
+// Массив текстур GL_TEXTURE_2D_ARRAY с мип-уровнями. Все текстуры
+// материалов лежат в одном объекте, шейдер выбирает слой по индексу,
+// поэтому на кадр нужна одна привязка вместо юнита на текстуру
+class TextureArray {
+ public:
+  TextureArray() = default;
+  ~TextureArray();
+
+  TextureArray(const TextureArray&) = delete;
+  TextureArray& operator=(const TextureArray&) = delete;
+
+  // Выделяет память под layers слоёв width x height со всеми
+  // мип-уровнями. Пока в слой ничего не загружено, в нём лежит серая
+  // заглушка
+  void Allocate(uint32_t width,
+                uint32_t height,
+                int layers,
+                TexturePackFormat format = TexturePackFormat::BGR8);
+
+  // Загружает мип-уровень level слоя в формате массива (BGR - строки
+  // выровнены по 4 байта). Несжатый слой можно передать и в другом
+  // порядке каналов (pixelFormat = GL_RGBA). Если привязан
+  // GL_PIXEL_UNPACK_BUFFER, pixels - смещение в нём
+  void UploadLayer(int layer,
+                   const void* pixels,
+                   int level = 0,
+                   GLenum pixelFormat = GL_BGR);
+
+  // Заполняет все мип-уровни слоя серой заглушкой - слой, отданный другой
+  // текстуре, не показывает прежнюю, пока не загружена новая
+  void UploadPlaceholder(int layer);
+
+  // Освобождает текстуру
+  void Release();
+
+  // Привязывает массив к активному текстурному юниту
+  void Bind() const;
+
+  GLuint GetID() const { return textureID_; }
+  uint32_t GetWidth() const { return width_; }
+  uint32_t GetHeight() const { return height_; }
+  int GetLayerCount() const { return layerCount_; }
+  int GetLevelCount() const { return levelCount_; }
+  TexturePackFormat GetFormat() const { return format_; }
+
+ private:
+  GLuint textureID_ = 0;
+  uint32_t width_ = 0;
+  uint32_t height_ = 0;
+  int layerCount_ = 0;
+  int levelCount_ = 0;
+  TexturePackFormat format_ = TexturePackFormat::BGR8;
+};
@@ -1,9 +1,12 @@
 #include "texture_manager.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <iostream>
-#include <set>
 #include <stdexcept>
-#include "raw_image.h"
+#include "core/job_system.h"
+#include "pixel_kernels.h"
 
 TextureManager& TextureManager::GetInstance() {
   static TextureManager instance;
@@ -12,95 +15,476 @@ TextureManager& TextureManager::GetInstance() {
 
 void TextureManager::Initialize() {
   // Получаем список всех ожидаемых имён объектов из sphere.json
+  std::vector<std::string> expected_names;
   std::ifstream sphere_file(sphere_json_path_);
   if (!sphere_file.is_open()) {
     std::cerr << "Warning: Cannot open sphere.json for texture check."
               << std::endl;
   } else {
     json sphere_data = json::parse(sphere_file);
-    std::vector<std::string> expected_names;
     for (const auto& item : sphere_data) {
       if (item.contains("name") && item["name"].is_string()) {
         expected_names.emplace_back(item["name"].get<std::string>());
       }
     }
+  }
+
+  // Готовый пакет: ни генерация, ни разбор BMP не нужны
+  if (!LoadPack(expected_names)) {
     // Если чего-то не хватает — запускаем Python-скрипт
     if (CheckNeedsGeneration(expected_names)) {
       GenerateTextures();
     }
+
+    // Загружаем манифест после возможной генерации
+    LoadManifest();
+  }
+
+  // Текстуры манифеста начинают загружаться сразу, пока загружается
+  // остальная сцена
+  std::vector<std::string> paths;
+  for (const auto& [key, path] : texture_paths_) {
+    paths.push_back(path);
+  }
+  Preload(paths);
+}
+
+bool TextureManager::LoadPack(const std::vector<std::string>& expected_names) {
+  if (!std::filesystem::exists(pack_path_) || !pack_.Open(pack_path_)) {
+    return false;
+  }
+
+  // Манифест берётся из пакета
+  std::map<std::string, std::string> paths;
+  for (size_t i = 0; i < pack_.GetCount(); ++i) {
+    const TexturePackEntry& entry = pack_.GetEntry(i);
+    paths[entry.name] = textures_dir_ + "/" + entry.file;
+  }
+  for (const auto& name : expected_names) {
+    if (!paths.count(name)) {
+      std::cerr << "Texture pack is missing '" << name << "', rebuilding "
+                << "textures from BMP" << std::endl;
+      pack_.Close();
+      return false;
+    }
+  }
+  texture_paths_ = std::move(paths);
+
+  // Слои выдаются по пути исходного файла, как и при загрузке BMP; самих
+  // файлов на диске может не быть
+  for (size_t i = 0; i < pack_.GetCount(); ++i) {
+    const std::string& file = texture_paths_[pack_.GetEntry(i).name];
+    pack_indices_[std::filesystem::path(file).lexically_normal()
+                      .generic_string()] = static_cast<int>(i);
+  }
+  layer_width_ = pack_.GetWidth();
+  layer_height_ = pack_.GetHeight();
+
+  // Сжатый формат, который драйвер не поддерживает, распаковывается в
+  // рабочих потоках
+  bool supported = IsTextureFormatSupported(pack_.GetFormat());
+  layer_format_ = supported ? pack_.GetFormat() : TexturePackFormat::BGR8;
+  if (!supported) {
+    std::cerr << "Compressed textures are not supported by the driver, "
+              << "unpacking on the CPU" << std::endl;
+  }
+  return true;
+}
+
+void TextureManager::EnforceCpuBudget() {
+  size_t cpuBytes = 0;
+  for (const LayerSource& source : layer_sources_) {
+    cpuBytes += source.GetCPUBytes();
+  }
+  for (LayerSource& source : layer_sources_) {
+    if (cpuBytes <= budget_.cpuBytes) {
+      break;
+    }
+    if (source.uploaded) {
+      cpuBytes -= source.GetCPUBytes();
+      ReleaseLayerCopy(source);
+    }
+  }
+}
+
+void TextureManager::SetBudget(const TextureBudget& budget) {
+  budget_ = budget;
+  budget_warned_ = false;
+  EnforceCpuBudget();
+}
+
+size_t TextureManager::GetMaxLayerCount() const {
+  if (layer_width_ == 0) {
+    return SIZE_MAX;  // Размер слоя ещё неизвестен
+  }
+  size_t layerBytes = MipChainSize(layer_format_, layer_width_, layer_height_);
+  return std::max<size_t>(budget_.gpuBytes / layerBytes, 1);
+}
+
+std::vector<TextureMemoryInfo> TextureManager::GetMemoryReport() const {
+  std::vector<TextureMemoryInfo> report;
+
+  // Массив занимает место в GPU целиком, вместе с незанятыми слоями
+  if (texture_array_.GetID() == 0) {
+    return report;
   }
+  size_t layerBytes = MipChainSize(layer_format_, layer_width_, layer_height_);
+  size_t allocated = static_cast<size_t>(texture_array_.GetLayerCount());
+  for (size_t layer = 0; layer < layer_slots_.size(); ++layer) {
+    const LayerSlot& slot = layer_slots_[layer];
+    report.push_back({"[layer " + std::to_string(layer) + ", refs " +
+                          std::to_string(slot.refs) + "] " + slot.path,
+                      layer < allocated ? layerBytes : 0,
+                      layer_sources_[layer].GetCPUBytes()});
+  }
+  if (allocated > layer_slots_.size()) {
+    report.push_back(
+        {"[unused layers]", (allocated - layer_slots_.size()) * layerBytes, 0});
+  }
+  return report;
+}
+
+void TextureManager::PrintMemoryReport(std::ostream& out) const {
+  size_t gpuBytes = 0;
+  size_t cpuBytes = 0;
+  out << "Texture memory (GPU KiB / CPU KiB):" << std::endl;
+  for (const TextureMemoryInfo& info : GetMemoryReport()) {
+    out << "  " << info.name << ": " << info.gpuBytes / 1024 << " / "
+        << info.cpuBytes / 1024 << std::endl;
+    gpuBytes += info.gpuBytes;
+    cpuBytes += info.cpuBytes;
+  }
+  out << "  total: " << gpuBytes / 1024 << " / " << cpuBytes / 1024
+      << std::endl;
+}
+
+int TextureManager::AcquireTextureLayer(const std::string& name) {
+  int layer = FindOrCreateLayer(name, true);
+  if (layer >= 0) {
+    LayerSlot& slot = layer_slots_[layer];
+    ++slot.refs;
+    slot.lastUse = ++use_clock_;
+  }
+  return layer;
+}
+
+void TextureManager::ReleaseTextureLayer(int layer) {
+  if (layer < 0 || layer >= static_cast<int>(layer_slots_.size()) ||
+      layer_slots_[layer].refs == 0) {
+    return;  // Например, менеджер уже остановлен
+  }
+  LayerSlot& slot = layer_slots_[layer];
+  --slot.refs;
+  slot.lastUse = ++use_clock_;
+}
 
-  // Загружаем манифест после возможной генерации
-  LoadManifest();
+void TextureManager::Preload(const std::vector<std::string>& names) {
+  for (const std::string& name : names) {
+    FindOrCreateLayer(name, false);
+  }
 }
 
-Texture* TextureManager::GetTexture(const std::string& name) {
+int TextureManager::FindOrCreateLayer(const std::string& name, bool evict) {
   if (name.empty()) {
-    return nullptr;
+    return -1;
+  }
+  auto known = layer_indices_.find(name);
+  if (known != layer_indices_.end()) {
+    return known->second;
   }
 
-  // Проверяем кэш уже загруженных текстур
-  if (loaded_textures_.count(name)) {
-    return loaded_textures_[name].get();
+  // Текстура из пакета: файла на диске может не быть
+  std::string path;
+  int packed = FindPackedTexture(name, path);
+  if (packed < 0) {
+    path = ResolvePath(name);
+    if (path.empty()) {
+      std::cerr << "TextureManager Error: Could not find file for '" << name
+                << "'" << std::endl;
+      layer_indices_[name] = -1;  // Не ищем повторно
+      return -1;
+    }
+    path = std::filesystem::path(path).lexically_normal().generic_string();
   }
 
-  std::string cleanName = std::filesystem::path(name).filename().string();
-  if (loaded_textures_.count(cleanName)) {
-    return loaded_textures_[cleanName].get();
+  // Одна текстура - один слой, сколько бы материалов на неё ни ссылалось
+  known = layer_indices_.find(path);
+  if (known != layer_indices_.end()) {
+    return known->second;
   }
 
-  // Локальный кэш ошибок (чтобы не спамить консоль повторяющимися сообщениями)
-  static std::set<std::string> reported_missing;
-  if (reported_missing.count(name) || reported_missing.count(cleanName)) {
-    return nullptr;
+  // Размер слоёв массива задаёт первая текстура; остальные приводятся к
+  // нему в рабочем потоке
+  if (layer_width_ == 0 && !readBMPSize(path, layer_width_, layer_height_)) {
+    std::cerr << "TextureManager Error: Failed to load BMP '" << path << "'"
+              << std::endl;
+    layer_width_ = layer_height_ = 0;
+    layer_indices_[path] = -1;  // Не пытаемся загрузить повторно
+    return -1;
   }
 
-  // Определяем реальный путь к файлу
-  std::string finalPath;
+  int layer = AllocateLayer(path, evict);
+  if (layer < 0) {
+    return -1;
+  }
+  if (packed < 0) {
+    DecodeLayer(layer, path);
+  } else if (layer_format_ == pack_.GetFormat()) {
+    layer_sources_[layer].packed = packed;
+    upload_queue_.push_back(layer);
+  } else {
+    DecodePackedLayer(layer, packed);
+  }
+  return layer;
+}
 
-  // Ищем в манифесте по короткому имени
-  auto itManifest = texture_paths_.find(cleanName);
-  if (itManifest != texture_paths_.end()) {
-    finalPath = itManifest->second;
+int TextureManager::AllocateLayer(const std::string& path, bool evict) {
+  // Массив заполнен: слой отдаётся от текстуры, которую дольше всех не
+  // использует ни один материал
+  int victim = -1;
+  if (layer_slots_.size() >= GetMaxLayerCount()) {
+    if (!evict) {
+      return -1;
+    }
+    for (size_t layer = 0; layer < layer_slots_.size(); ++layer) {
+      const LayerSlot& slot = layer_slots_[layer];
+      if (slot.refs == 0 &&
+          (victim < 0 || slot.lastUse < layer_slots_[victim].lastUse)) {
+        victim = static_cast<int>(layer);
+      }
+    }
+    // Всё занято - массив растёт сверх бюджета, иначе материал останется
+    // без текстуры
+    if (victim < 0 && !budget_warned_) {
+      std::cerr << "Texture GPU budget exceeded: all " << layer_slots_.size()
+                << " layers are referenced by materials" << std::endl;
+      budget_warned_ = true;
+    }
   }
-  // Проверяем прямой путь
-  else if (std::filesystem::exists(name)) {
-    finalPath = name;
+
+  if (victim < 0) {
+    victim = static_cast<int>(layer_slots_.size());
+    layer_slots_.emplace_back();
+    layer_sources_.emplace_back();
+  } else {
+    layer_indices_.erase(layer_slots_[victim].path);
+    std::erase(upload_queue_, victim);
+    layer_sources_[victim] = LayerSource{};
+    ++layer_slots_[victim].generation;
+    // До загрузки новой текстуры в слое заглушка, а не вытесненная
+    texture_array_.UploadPlaceholder(victim);
   }
-  // Проверяем путь относительно папки текстур
-  else {
-    std::filesystem::path p = std::filesystem::path(textures_dir_) / cleanName;
-    if (std::filesystem::exists(p)) {
-      finalPath = p.string();
+  layer_slots_[victim].path = path;
+  layer_indices_[path] = victim;
+  return victim;
+}
+
+void TextureManager::DecodeLayer(int layer, const std::string& path) {
+  SubmitDecode(layer, [this, path](LayerSource& source) {
+    source.path = path;
+    RawImage image = loadFromBMP(path);
+    if (image.GetWidth() == 0) {
+      return;
+    }
+    if (image.GetWidth() != layer_width_ ||
+        image.GetHeight() != layer_height_) {
+      image = resampleImage(image, layer_width_, layer_height_);
     }
+    // Мип-уровни (и сжатие, если массив сжат) считаются здесь же, а не
+    // драйвером по всему массиву в потоке рендера
+    source.chain = BuildMipChain(image, layer_format_);
+  });
+}
+
+void TextureManager::DecodePackedLayer(int layer, int index) {
+  SubmitDecode(layer, [this, index](LayerSource& source) {
+    source.packIndex = index;
+    for (uint32_t level = 0; level < pack_.GetLevelCount(); ++level) {
+      RawImage image = DecompressImage(
+          pack_.GetLevel(index, level), pack_.GetFormat(),
+          std::max(layer_width_ >> level, 1u),
+          std::max(layer_height_ >> level, 1u));
+      source.chain.insert(source.chain.end(), image.raw_data(),
+                          image.raw_data() + image.raw_size());
+    }
+  });
+}
+
+void TextureManager::SubmitDecode(
+    int layer,
+    std::function<void(LayerSource&)> decode) {
+  {
+    std::lock_guard<std::mutex> lock(decode_mutex_);
+    ++pending_decodes_;
   }
+  uint32_t generation = layer_slots_[layer].generation;
+  JobSystem::GetInstance().Submit([this, layer, generation, decode]() {
+    DecodedLayer decoded;
+    decoded.layer = layer;
+    decoded.generation = generation;
+    decode(decoded.source);
+
+    std::lock_guard<std::mutex> lock(decode_mutex_);
+    decoded_.push_back(std::move(decoded));
+    --pending_decodes_;
+    decode_done_.notify_all();
+  });
+}
 
-  if (finalPath.empty()) {
-    std::cerr << "TextureManager Error: Could not find file for '" << name
-              << "'" << std::endl;
-    reported_missing.insert(name);  // Запоминаем ошибку
-    return nullptr;
+void TextureManager::MarkUploaded(LayerSource& source) {
+  source.uploaded = true;
+  if (!budget_.keepCpuCopies) {
+    ReleaseLayerCopy(source);
   }
+}
 
-  // Загружаем изображение и создаём текстуру
-  try {
-    RawImage img = loadFromBMP(finalPath);
+void TextureManager::ReleaseLayerCopy(LayerSource& source) {
+  // Слой из пакета остаётся доступен через отображение
+  std::vector<uint8_t>().swap(source.chain);
+}
 
-    auto newTexture = std::make_unique<Texture>(img);
-    newTexture->createTexture();
+void TextureManager::ReloadLayer(int layer) {
+  LayerSource& source = layer_sources_[layer];
+  source.uploaded = false;
+  if (source.packIndex >= 0) {
+    DecodePackedLayer(layer, source.packIndex);
+  } else if (!source.path.empty()) {
+    DecodeLayer(layer, source.path);
+  }
+}
 
-    Texture* ptr = newTexture.get();
+size_t TextureManager::GetLevelSize(int level, GLenum pixelFormat) const {
+  if (pixelFormat == GL_RGBA) {
+    return size_t(std::max(layer_width_ >> level, 1u)) *
+           std::max(layer_height_ >> level, 1u) * 4;
+  }
+  return MipLevelSize(layer_format_, layer_width_, layer_height_,
+                      static_cast<uint32_t>(level));
+}
+
+void TextureManager::UploadChain(int layer,
+                                 const uint8_t* data,
+                                 GLenum pixelFormat) {
+  for (int level = 0; level < texture_array_.GetLevelCount(); ++level) {
+    texture_array_.UploadLayer(layer, data, level, pixelFormat);
+    data += GetLevelSize(level, pixelFormat);
+  }
+}
 
-    // Кэшируем под исходным именем
-    loaded_textures_[name] = std::move(newTexture);
+void TextureManager::Update(size_t byteBudget) {
+  int layerCount = static_cast<int>(layer_sources_.size());
+  if (layerCount == 0) {
+    return;
+  }
+
+  // Добавились слои - массив выделяется заново с запасом (вдвое, но не
+  // сверх бюджета), уже готовые слои загружаются в него повторно
+  if (texture_array_.GetLayerCount() < layerCount) {
+    size_t capacity = std::min<size_t>(
+        size_t(texture_array_.GetLayerCount()) * 2, GetMaxLayerCount());
+    texture_array_.Allocate(layer_width_, layer_height_,
+                            std::max(layerCount, static_cast<int>(capacity)),
+                            layer_format_);
+    upload_queue_.clear();
+    for (int layer = 0; layer < layerCount; ++layer) {
+      if (layer_sources_[layer].IsReady()) {
+        upload_queue_.push_back(layer);
+      } else if (layer_sources_[layer].uploaded) {
+        ReloadLayer(layer);  // Копия уже освобождена
+      }
+    }
+  }
+
+  // Забираем результаты рабочих потоков
+  std::vector<DecodedLayer> decoded;
+  {
+    std::lock_guard<std::mutex> lock(decode_mutex_);
+    decoded.swap(decoded_);
+  }
+  for (DecodedLayer& item : decoded) {
+    if (item.generation != layer_slots_[item.layer].generation) {
+      continue;  // Слой уже отдан другой текстуре
+    }
+    if (!item.source.IsReady()) {
+      continue;  // Файл не загрузился - в слое остаётся заглушка
+    }
+    layer_sources_[item.layer] = std::move(item.source);
+    upload_queue_.push_back(item.layer);
+  }
+  if (upload_queue_.empty()) {
+    return;
+  }
 
-    return ptr;
-  } catch (const std::exception& e) {
-    std::cerr << "TextureManager Error: Failed to load BMP '" << finalPath
-              << "': " << e.what() << std::endl;
-    reported_missing.insert(name);
-    return nullptr;
+  // Сколько слоёв помещается в бюджет кадра (хотя бы один). В буфер
+  // мип-цепочки несжатых слоёв кладутся как RGBA8: 4-байтовые текселы
+  // драйвер забирает без перепаковки, в отличие от 3-байтовых BGR
+  bool staging = layer_format_ == TexturePackFormat::BGR8;
+  GLenum stagedFormat = staging ? GL_RGBA : GL_BGR;
+  size_t layerBytes = 0;
+  for (int level = 0; level < texture_array_.GetLevelCount(); ++level) {
+    layerBytes += GetLevelSize(level, stagedFormat);
   }
+  size_t layersPerFrame = std::max<size_t>(byteBudget / layerBytes, 1);
+
+  // Слои из пакета загружаются прямо из отображения, сжатые цепочки - из
+  // памяти, остальные копируются в регион буфера; драйвер забирает их из
+  // него без остановки конвейера
+  std::vector<int> staged;
+  uint8_t* dst = nullptr;
+  for (size_t count = 0; count < layersPerFrame && !upload_queue_.empty();
+       ++count) {
+    int layer = upload_queue_.front();
+    upload_queue_.pop_front();
+    LayerSource& source = layer_sources_[layer];
+    if (source.packed >= 0 || !staging) {
+      UploadChain(layer, source.chain.empty() ? pack_.GetLevel(source.packed, 0)
+                                              : source.chain.data());
+      MarkUploaded(source);
+      continue;
+    }
+
+    if (!dst) {
+      size_t regionSize = layersPerFrame * layerBytes;
+      if (!staging_ || staging_->GetRegionSize() != regionSize) {
+        staging_ = std::make_unique<StreamBuffer>(GL_PIXEL_UNPACK_BUFFER,
+                                                  regionSize);
+      }
+      dst = static_cast<uint8_t*>(staging_->BeginWrite());
+      if (!dst) {
+        // Буфер ещё занят GPU - слой загрузится в следующем кадре
+        upload_queue_.push_front(layer);
+        break;
+      }
+    }
+    uint8_t* levelDst = dst + staged.size() * layerBytes;
+    const uint8_t* levelSrc = source.chain.data();
+    for (int level = 0; level < texture_array_.GetLevelCount(); ++level) {
+      uint32_t width = std::max(layer_width_ >> level, 1u);
+      uint32_t height = std::max(layer_height_ >> level, 1u);
+      size_t stride = ((width * 24 + 31) / 32) * 4;
+      for (uint32_t y = 0; y < height; ++y) {
+        BGRToRGBARow(levelSrc + stride * y, levelDst + size_t(width) * 4 * y,
+                     width);
+      }
+      levelSrc += GetLevelSize(level, GL_BGR);
+      levelDst += GetLevelSize(level, GL_RGBA);
+    }
+    MarkUploaded(source);  // Данные уже в буфере
+    staged.push_back(layer);
+  }
+  EnforceCpuBudget();
+  if (!dst) {
+    return;
+  }
+  staging_->EndWrite(staged.size() * layerBytes, 0);
+
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, staging_->GetBuffer());
+  for (size_t i = 0; i < staged.size(); ++i) {
+    size_t offset = staging_->GetOffset() + i * layerBytes;
+    UploadChain(staged[i], reinterpret_cast<const uint8_t*>(offset), GL_RGBA);
+  }
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  staging_->EndFrame();
 }
 
 const std::string& TextureManager::GetTexturePath(
@@ -113,8 +497,58 @@ const std::string& TextureManager::GetTexturePath(
 }
 
 void TextureManager::Shutdown() {
-  loaded_textures_.clear();
   texture_paths_.clear();
+
+  // Рабочие потоки пишут в decoded_ - дожидаемся их
+  {
+    std::unique_lock<std::mutex> lock(decode_mutex_);
+    decode_done_.wait(lock, [this]() { return pending_decodes_ == 0; });
+    decoded_.clear();
+  }
+  layer_indices_.clear();
+  layer_slots_.clear();
+  layer_sources_.clear();
+  use_clock_ = 0;
+  budget_warned_ = false;
+  layer_width_ = layer_height_ = 0;
+  layer_format_ = TexturePackFormat::BGR8;
+  upload_queue_.clear();
+  staging_.reset();
+  pack_.Close();
+  pack_indices_.clear();
+  texture_array_.Release();
+}
+
+int TextureManager::FindPackedTexture(const std::string& name,
+                                      std::string& path) const {
+  if (!pack_.IsOpen()) {
+    return -1;
+  }
+  auto manifest = texture_paths_.find(name);
+  path = manifest != texture_paths_.end() ? manifest->second : name;
+  path = std::filesystem::path(path).lexically_normal().generic_string();
+  auto it = pack_indices_.find(path);
+  return it != pack_indices_.end() ? it->second : -1;
+}
+
+std::string TextureManager::ResolvePath(const std::string& name) const {
+  std::string cleanName = std::filesystem::path(name).filename().string();
+
+  // Ищем в манифесте по короткому имени
+  auto itManifest = texture_paths_.find(cleanName);
+  if (itManifest != texture_paths_.end()) {
+    return itManifest->second;
+  }
+  // Проверяем прямой путь
+  if (std::filesystem::exists(name)) {
+    return name;
+  }
+  // Проверяем путь относительно папки текстур
+  std::filesystem::path p = std::filesystem::path(textures_dir_) / cleanName;
+  if (std::filesystem::exists(p)) {
+    return p.string();
+  }
+  return "";
 }
 
 void TextureManager::LoadManifest() {
@@ -1,19 +1,68 @@
 #pragma once
 
+#include <condition_variable>
+#include <deque>
 #include <filesystem>
+#include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <nlohmann/json.hpp>
+#include <ostream>
 #include <string>
-#include "texture.h"
+#include "gl/stream_buffer.h"
+#include "raw_image.h"
+#include "texture_array.h"
+#include "texture_pack.h"
 
 using json = nlohmann::json;
 
+// Ограничения памяти текстур
+struct TextureBudget {
+  size_t gpuBytes = size_t{256} << 20;  // Массив текстур материалов
+  size_t cpuBytes = size_t{64} << 20;   // Копии изображений в памяти процесса
+  bool keepCpuCopies = false;  // Хранить копии после загрузки в GPU
+};
+
+// Память, занятая одной текстурой
+struct TextureMemoryInfo {
+  std::string name;
+  size_t gpuBytes = 0;
+  size_t cpuBytes = 0;
+};
+
 class TextureManager {
  public:
   static TextureManager& GetInstance();
   void Initialize();
-  Texture* GetTexture(const std::string& name);
+
+  // Ограничения памяти. Массив материалов не растёт сверх бюджета GPU
+  // (считается вся мип-цепочка слоя): новая текстура занимает слой, на
+  // который давно не ссылается ни один материал. Уже выделенный массив
+  // при уменьшении бюджета не сжимается. Сверх бюджета CPU слои теряют
+  // копии в памяти процесса
+  void SetBudget(const TextureBudget& budget);
+
+  // Память по текстурам: слои массива и его незанятые слои
+  std::vector<TextureMemoryInfo> GetMemoryReport() const;
+  void PrintMemoryReport(std::ostream& out) const;
+
+  // Слой текстуры в общем массиве материалов (-1, если файл не найден).
+  // Слой выдаётся сразу, файл декодируется в пуле потоков; пока он не
+  // загружен в GPU, в слое лежит заглушка. Материал держит слой, пока не
+  // вернёт его через ReleaseTextureLayer
+  int AcquireTextureLayer(const std::string& name);
+  void ReleaseTextureLayer(int layer);
+
+  // Заранее ставит текстуры в очередь загрузки, пока в массиве есть место
+  void Preload(const std::vector<std::string>& names);
+
+  // Загружает в GPU декодированные слои, не больше byteBudget байт за
+  // вызов (но хотя бы один слой). Вызывается в потоке GL раз в кадр
+  void Update(size_t byteBudget);
+
+  // Массив текстур материалов
+  const TextureArray& GetTextureArray() const { return texture_array_; }
   const std::string& GetTexturePath(const std::string& name) const;
   void Shutdown();
 
@@ -27,19 +76,127 @@ class TextureManager {
   // Загрузка манифеста
   void LoadManifest();
 
+  // Открывает пакет текстур и берёт из него манифест. Возвращает false,
+  // если пакета нет или в нём не хватает текстур из expected_names
+  bool LoadPack(const std::vector<std::string>& expected_names);
+
+  // Путь к файлу текстуры по имени из манифеста или пути (пустая строка,
+  // если файл не найден)
+  std::string ResolvePath(const std::string& name) const;
+
+  // Индекс текстуры в пакете по имени из манифеста или пути (-1, если её
+  // там нет); path получает нормализованный путь исходного файла
+  int FindPackedTexture(const std::string& name, std::string& path) const;
+
   // Проверка необходимости генерации
   bool CheckNeedsGeneration(const std::vector<std::string>& expected_names);
 
   // Запуск Python-скрипта для генерации
   void GenerateTextures();
 
+  // Освобождает копии загруженных в GPU слоёв сверх бюджета
+  void EnforceCpuBudget();
+
   std::map<std::string, std::string> texture_paths_;  // Кэш путей из манифеста
-  std::map<std::string, std::unique_ptr<Texture>>
-      loaded_textures_;  // Кэш загруженных GPU текстур
+  TextureBudget budget_;
+
+  // Слой по имени или пути; если массив заполнен, evict разрешает занять
+  // слой без ссылок, иначе возвращается -1
+  int FindOrCreateLayer(const std::string& name, bool evict);
+
+  // Слой под текстуру path: новый, пока массив в бюджете, затем - давно
+  // освобождённый материалами
+  int AllocateLayer(const std::string& path, bool evict);
+
+  // Сколько слоёв помещается в бюджет GPU
+  size_t GetMaxLayerCount() const;
+
+  struct LayerSource;
+
+  // Готовят мип-цепочку слоя в рабочем потоке и кладут её в decoded_: из
+  // BMP-файла или, если драйвер не знает сжатый формат пакета,
+  // распаковкой текстуры из пакета
+  void DecodeLayer(int layer, const std::string& path);
+  void DecodePackedLayer(int layer, int index);
+  void SubmitDecode(int layer, std::function<void(LayerSource&)> decode);
+
+  // Загружает в массив мип-цепочку слоя, начиная с data (в памяти или
+  // смещение в привязанном GL_PIXEL_UNPACK_BUFFER). Уровни несжатого
+  // массива можно передать как RGBA8 без выравнивания строк
+  void UploadChain(int layer, const uint8_t* data, GLenum pixelFormat = GL_BGR);
+
+  // Размер мип-уровня level слоя в порядке каналов pixelFormat
+  size_t GetLevelSize(int level, GLenum pixelFormat) const;
+
+  // Отмечает слой загруженным и, если копии не нужны, освобождает их
+  void MarkUploaded(LayerSource& source);
+  static void ReleaseLayerCopy(LayerSource& source);
+
+  // Заново готовит слой, копия которого уже освобождена
+  void ReloadLayer(int layer);
+
+  // Пиксели слоя: мип-цепочка в формате массива - прямо из пакета или
+  // собранная в рабочем потоке
+  struct LayerSource {
+    int packed = -1;             // Индекс текстуры в пакете
+    std::vector<uint8_t> chain;  // Мип-цепочка, если не из пакета
+
+    // Откуда слой загружен: файл или текстура пакета для распаковки
+    std::string path;
+    int packIndex = -1;
+    bool uploaded = false;  // Слой уже в GPU
+
+    size_t GetCPUBytes() const { return chain.size(); }
+
+    bool IsReady() const { return packed >= 0 || !chain.empty(); }
+  };
+
+  // Владелец слоя: путь текстуры, число ссылающихся материалов и момент
+  // последнего обращения. Поколение растёт, когда слой отдаётся другой
+  // текстуре, - так отбрасываются запоздавшие результаты декодирования
+  struct LayerSlot {
+    std::string path;
+    int refs = 0;
+    uint64_t lastUse = 0;
+    uint32_t generation = 0;
+  };
+
+  // Подготовленный, но ещё не загруженный в GPU слой
+  struct DecodedLayer {
+    int layer = -1;
+    uint32_t generation = 0;
+    LayerSource source;
+  };
+
+  // Слои массива текстур: индекс по пути файла, владельцы и источники по
+  // порядку (пустые, пока слой не подготовлен)
+  std::map<std::string, int> layer_indices_;
+  std::vector<LayerSlot> layer_slots_;
+  std::vector<LayerSource> layer_sources_;
+  uint64_t use_clock_ = 0;
+  bool budget_warned_ = false;
+  uint32_t layer_width_ = 0;  // Размер слоя задаёт первая текстура
+  uint32_t layer_height_ = 0;
+  TexturePackFormat layer_format_ = TexturePackFormat::BGR8;
+  TextureArray texture_array_;
+
+  // Результаты рабочих потоков
+  std::mutex decode_mutex_;
+  std::condition_variable decode_done_;
+  std::vector<DecodedLayer> decoded_;
+  int pending_decodes_ = 0;
+
+  // Слои, ждущие загрузки в GPU, и буфер для их передачи
+  std::deque<int> upload_queue_;
+  std::unique_ptr<StreamBuffer> staging_;
+
+  TexturePack pack_;  // Пакет текстур, собранный texture_packer
+  std::map<std::string, int> pack_indices_;  // Путь исходного файла -> индекс
 
   const std::string textures_dir_ = "assets/textures";
   const std::string sphere_json_path_ = "assets/scene/objects/sphere.json";
   const std::string manifest_path_ = "assets/textures/textures_manifest.json";
+  const std::string pack_path_ = "assets/textures/textures.pack";
   const std::string python_script_cmd_ =
       "python assets/textures/script_for_textures.py";
 };
@@ -0,0 +1,265 @@
+#include "texture_pack.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include "block_compression.h"
+#include "core/job_system.h"
+#include "pixel_kernels.h"
+
+uint32_t MipLevelCount(uint32_t width, uint32_t height) {
+  uint32_t levels = 1;
+  for (uint32_t size = std::max(width, height); size > 1; size >>= 1) {
+    ++levels;
+  }
+  return levels;
+}
+
+size_t MipLevelSize(TexturePackFormat format,
+                    uint32_t width,
+                    uint32_t height,
+                    uint32_t level) {
+  size_t w = std::max<uint32_t>(width >> level, 1);
+  size_t h = std::max<uint32_t>(height >> level, 1);
+  size_t blocks = ((w + 3) / 4) * ((h + 3) / 4);
+  switch (format) {
+    case TexturePackFormat::BGR8:
+      return ((w * 24 + 31) / 32) * 4 * h;
+    case TexturePackFormat::BC1:
+      return blocks * 8;
+    case TexturePackFormat::BC3:
+    case TexturePackFormat::BC7:
+      return blocks * 16;
+  }
+  return 0;
+}
+
+size_t MipChainSize(TexturePackFormat format, uint32_t width, uint32_t height) {
+  size_t size = 0;
+  for (uint32_t level = 0; level < MipLevelCount(width, height); ++level) {
+    size += MipLevelSize(format, width, height, level);
+  }
+  return size;
+}
+
+std::vector<uint8_t> CompressImage(const RawImage& image,
+                                   TexturePackFormat format) {
+  if (format == TexturePackFormat::BGR8) {
+    return std::vector<uint8_t>(image.raw_data(),
+                                image.raw_data() + image.raw_size());
+  }
+
+  uint32_t width = image.GetWidth();
+  uint32_t height = image.GetHeight();
+  size_t blockBytes = format == TexturePackFormat::BC1 ? 8 : 16;
+  size_t blocksX = (width + 3) / 4;
+  size_t blocksY = (height + 3) / 4;
+  std::vector<uint8_t> data(blocksX * blocksY * blockBytes);
+
+  // Строки блоков независимы и делятся между потоками пула
+  JobSystem::GetInstance().ParallelFor(
+      blocksY, 4, [&](size_t begin, size_t end, size_t) {
+        uint8_t rgba[64];
+        std::vector<uint8_t> rows(size_t(width) * 4 * 4);
+        for (size_t by = begin; by < end; ++by) {
+          // Четыре строки блоков переводятся в RGBA целиком; строки за
+          // нижним краем повторяют последнюю
+          for (uint32_t row = 0; row < 4; ++row) {
+            uint32_t y = std::min<uint32_t>(by * 4 + row, height - 1);
+            BGRToRGBARow(image.GetRow(y).data(),
+                         rows.data() + size_t(width) * 4 * row, width);
+          }
+          for (size_t bx = 0; bx < blocksX; ++bx) {
+            // Пиксели за правым краем повторяют крайние
+            for (uint32_t i = 0; i < 16; ++i) {
+              uint32_t x = std::min<uint32_t>(bx * 4 + i % 4, width - 1);
+              std::memcpy(rgba + i * 4,
+                          rows.data() + (size_t(width) * (i / 4) + x) * 4, 4);
+            }
+            uint8_t* block = data.data() + (by * blocksX + bx) * blockBytes;
+            switch (format) {
+              case TexturePackFormat::BC1:
+                EncodeBC1Block(rgba, block);
+                break;
+              case TexturePackFormat::BC3:
+                EncodeBC3Block(rgba, block);
+                break;
+              default:
+                EncodeBC7Block(rgba, block);
+                break;
+            }
+          }
+        }
+      });
+  return data;
+}
+
+RawImage DecompressImage(const uint8_t* data,
+                         TexturePackFormat format,
+                         uint32_t width,
+                         uint32_t height) {
+  RawImage image(width, height);
+  if (format == TexturePackFormat::BGR8) {
+    std::memcpy(image.raw_data(), data, image.raw_size());
+    return image;
+  }
+
+  size_t blockBytes = format == TexturePackFormat::BC1 ? 8 : 16;
+  size_t blocksX = (width + 3) / 4;
+  size_t blocksY = (height + 3) / 4;
+  uint8_t rgba[64];
+  for (size_t by = 0; by < blocksY; ++by) {
+    for (size_t bx = 0; bx < blocksX; ++bx) {
+      const uint8_t* block = data + (by * blocksX + bx) * blockBytes;
+      switch (format) {
+        case TexturePackFormat::BC1:
+          DecodeBC1Block(block, rgba);
+          break;
+        case TexturePackFormat::BC3:
+          DecodeBC3Block(block, rgba);
+          break;
+        default:
+          DecodeBC7Block(block, rgba);
+          break;
+      }
+      for (uint32_t i = 0; i < 16; ++i) {
+        uint32_t x = static_cast<uint32_t>(bx * 4 + i % 4);
+        uint32_t y = static_cast<uint32_t>(by * 4 + i / 4);
+        if (x < width && y < height) {
+          const uint8_t* pixel = rgba + i * 4;
+          image.SetPixel(x, y, RGB{pixel[0], pixel[1], pixel[2]});
+        }
+      }
+    }
+  }
+  return image;
+}
+
+std::vector<uint8_t> BuildMipChain(const RawImage& image,
+                                   TexturePackFormat format) {
+  std::vector<uint8_t> chain = CompressImage(image, format);
+  uint32_t levels = MipLevelCount(image.GetWidth(), image.GetHeight());
+
+  // Билинейная выборка в центрах пар пикселей - это усреднение 2x2
+  RawImage level = image;
+  for (uint32_t i = 1; i < levels; ++i) {
+    level = resampleImage(level, std::max(level.GetWidth() / 2, 1u),
+                          std::max(level.GetHeight() / 2, 1u));
+    std::vector<uint8_t> data = CompressImage(level, format);
+    chain.insert(chain.end(), data.begin(), data.end());
+  }
+  return chain;
+}
+
+bool WriteTexturePack(const std::string& filename,
+                      TexturePackFormat format,
+                      uint32_t width,
+                      uint32_t height,
+                      const std::vector<PackedTexture>& textures) {
+  TexturePackHeader header;
+  header.format = static_cast<uint32_t>(format);
+  header.width = width;
+  header.height = height;
+  header.levels = MipLevelCount(width, height);
+  header.count = static_cast<uint32_t>(textures.size());
+
+  // Данные идут сразу за таблицей
+  std::vector<TexturePackEntry> entries(textures.size());
+  uint64_t offset =
+      sizeof(TexturePackHeader) + sizeof(TexturePackEntry) * entries.size();
+  for (size_t i = 0; i < textures.size(); ++i) {
+    const PackedTexture& texture = textures[i];
+    if (texture.name.size() >= sizeof(entries[i].name) ||
+        texture.file.size() >= sizeof(entries[i].file)) {
+      std::cerr << "Texture name is too long: " << texture.name << std::endl;
+      return false;
+    }
+    std::memcpy(entries[i].name, texture.name.data(), texture.name.size());
+    std::memcpy(entries[i].file, texture.file.data(), texture.file.size());
+    entries[i].offset = offset;
+    entries[i].size = texture.data.size();
+    offset += texture.data.size();
+  }
+
+  std::ofstream out(filename, std::ios::binary);
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  out.write(reinterpret_cast<const char*>(entries.data()),
+            sizeof(TexturePackEntry) * entries.size());
+  for (const PackedTexture& texture : textures) {
+    out.write(reinterpret_cast<const char*>(texture.data.data()),
+              texture.data.size());
+  }
+  return static_cast<bool>(out);
+}
+
+bool TexturePack::Open(const std::string& filename) {
+  Close();
+  if (!file_.Open(filename)) {
+    return false;
+  }
+
+  auto fail = [&](const char* reason) {
+    std::cerr << "Invalid texture pack '" << filename << "': " << reason
+              << std::endl;
+    Close();
+    return false;
+  };
+
+  if (file_.GetSize() < sizeof(TexturePackHeader)) {
+    return fail("file is too small");
+  }
+  std::memcpy(&header_, file_.GetData(), sizeof(TexturePackHeader));
+  if (std::memcmp(header_.magic, "ETPK", 4) != 0 || header_.version != 1) {
+    return fail("unknown format version");
+  }
+  if (header_.format > static_cast<uint32_t>(TexturePackFormat::BC7)) {
+    return fail("unknown pixel format");
+  }
+  format_ = static_cast<TexturePackFormat>(header_.format);
+  if (header_.width == 0 || header_.height == 0 ||
+      header_.levels != MipLevelCount(header_.width, header_.height)) {
+    return fail("invalid dimensions");
+  }
+
+  // Смещения уровней внутри данных одной текстуры
+  levelOffsets_.resize(header_.levels);
+  size_t textureSize = 0;
+  for (uint32_t level = 0; level < header_.levels; ++level) {
+    levelOffsets_[level] = textureSize;
+    textureSize += GetLevelSize(level);
+  }
+
+  size_t tableEnd = sizeof(TexturePackHeader) +
+                    sizeof(TexturePackEntry) * size_t{header_.count};
+  if (file_.GetSize() < tableEnd) {
+    return fail("entry table is truncated");
+  }
+  entries_.resize(header_.count);
+  std::memcpy(entries_.data(), file_.GetData() + sizeof(TexturePackHeader),
+              sizeof(TexturePackEntry) * entries_.size());
+  for (TexturePackEntry& entry : entries_) {
+    entry.name[sizeof(entry.name) - 1] = '\0';
+    entry.file[sizeof(entry.file) - 1] = '\0';
+    if (entry.size != textureSize || entry.offset < tableEnd ||
+        entry.offset > file_.GetSize() ||
+        file_.GetSize() - entry.offset < entry.size) {
+      return fail("texture data is truncated");
+    }
+  }
+  return true;
+}
+
+void TexturePack::Close() {
+  file_.Close();
+  header_ = TexturePackHeader();
+  entries_.clear();
+  levelOffsets_.clear();
+}
+
+const uint8_t* TexturePack::GetLevel(size_t index, uint32_t level) const {
+  return file_.GetData() + entries_[index].offset + levelOffsets_[level];
+}
+
+size_t TexturePack::GetLevelSize(uint32_t level) const {
+  return MipLevelSize(format_, header_.width, header_.height, level);
+}
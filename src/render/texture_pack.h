@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "core/mapped_file.h"
+#include "raw_image.h"
+
+// Пакет текстур: все текстуры материалов одного размера с готовыми
+// мип-уровнями в одном файле. Собирается заранее утилитой texture_packer,
+// во время работы отображается в память и загружается в GPU без
+// декодирования.
+//
+// Формат: TexturePackHeader, таблица из count записей TexturePackEntry,
+// затем данные. Данные текстуры - мип-уровни подряд от 0 до levels - 1
+enum class TexturePackFormat : uint32_t {
+  BGR8 = 0,  // Строки BGR, выровненные по 4 байта (как в BMP)
+  BC1 = 1,   // 8 байт на блок 4x4, RGB
+  BC3 = 2,   // 16 байт на блок 4x4, RGBA
+  BC7 = 3,   // 16 байт на блок 4x4, RGBA высокого качества
+};
+
+#pragma pack(push, 1)
+struct TexturePackHeader {
+  char magic[4] = {'E', 'T', 'P', 'K'};
+  uint32_t version = 1;
+  uint32_t format = 0;  // TexturePackFormat
+  uint32_t width = 0;   // Размер уровня 0 всех текстур
+  uint32_t height = 0;
+  uint32_t levels = 0;  // Полная цепочка до 1x1
+  uint32_t count = 0;   // Число текстур
+  uint32_t reserved = 0;
+};
+
+struct TexturePackEntry {
+  char name[64] = {};  // Имя из манифеста
+  char file[64] = {};  // Исходный файл относительно папки текстур
+  uint64_t offset = 0;  // Начало данных от начала файла
+  uint64_t size = 0;    // Размер всех мип-уровней
+};
+#pragma pack(pop)
+
+// Число уровней полной мип-цепочки
+uint32_t MipLevelCount(uint32_t width, uint32_t height);
+
+// Размер одного мип-уровня в байтах
+size_t MipLevelSize(TexturePackFormat format,
+                    uint32_t width,
+                    uint32_t height,
+                    uint32_t level);
+
+// Размер полной мип-цепочки в байтах
+size_t MipChainSize(TexturePackFormat format, uint32_t width, uint32_t height);
+
+// Кодирует изображение в формат format (блоки считаются параллельно)
+std::vector<uint8_t> CompressImage(const RawImage& image,
+                                   TexturePackFormat format);
+
+// Декодирует уровень width x height формата format в BGR
+RawImage DecompressImage(const uint8_t* data,
+                         TexturePackFormat format,
+                         uint32_t width,
+                         uint32_t height);
+
+// Полная мип-цепочка изображения в формате format: уровни получаются
+// усреднением 2x2 предыдущего и идут подряд
+std::vector<uint8_t> BuildMipChain(const RawImage& image,
+                                   TexturePackFormat format);
+
+// Текстура для записи в пакет
+struct PackedTexture {
+  std::string name;
+  std::string file;
+  std::vector<uint8_t> data;  // Все мип-уровни подряд
+};
+
+// Записывает пакет. Возвращает false при ошибке записи
+bool WriteTexturePack(const std::string& filename,
+                      TexturePackFormat format,
+                      uint32_t width,
+                      uint32_t height,
+                      const std::vector<PackedTexture>& textures);
+
+// Пакет, отображённый в память
+class TexturePack {
+ public:
+  // Открывает и проверяет пакет. Ошибки формата пишутся в std::cerr
+  bool Open(const std::string& filename);
+  void Close();
+
+  bool IsOpen() const { return file_.IsOpen(); }
+  TexturePackFormat GetFormat() const { return format_; }
+  uint32_t GetWidth() const { return header_.width; }
+  uint32_t GetHeight() const { return header_.height; }
+  uint32_t GetLevelCount() const { return header_.levels; }
+  size_t GetCount() const { return entries_.size(); }
+
+  const TexturePackEntry& GetEntry(size_t index) const {
+    return entries_[index];
+  }
+
+  // Данные мип-уровня level текстуры index
+  const uint8_t* GetLevel(size_t index, uint32_t level) const;
+  size_t GetLevelSize(uint32_t level) const;
+
+ private:
+  MappedFile file_;
+  TexturePackHeader header_;
+  TexturePackFormat format_ = TexturePackFormat::BGR8;
+  std::vector<TexturePackEntry> entries_;
+  std::vector<size_t> levelOffsets_;  // Смещения уровней внутри текстуры
+};
@@ -0,0 +1,294 @@
+// Регрессионный тест CPU-рендера по эталонным изображениям.
+//
+// Рендерит фиксированные сцены без окна через Renderer, сравнивает кадр с
+// эталоном из tests/golden по тайлам (PSNR по яркостно-взвешенной ошибке)
+// и дописывает время кадра в CSV, чтобы у оптимизаций рендера была и
+// проверка корректности, и история скорости.
+//
+//   golden_image_test [--update] [--size WxH] [--frames N]
+//                     [--min-psnr dB] [--min-tile-psnr dB]
+//                     [--timings file.csv] [--scene name]
+//
+// --update перезаписывает эталоны текущим результатом.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "core/job_system.h"
+#include "render/image_writer.h"
+#include "render/raw_image.h"
+#include "render/renderer.h"
+#include "render/scene_loader.h"
+
+#ifndef ENGINE_SOURCE_DIR
+#define ENGINE_SOURCE_DIR "."
+#endif
+
+namespace {
+
+struct GoldenScene {
+  const char* name;
+  const char* path;  // Относительно корня репозитория
+};
+
+const GoldenScene kScenes[] = {
+    {"physics_test_scene", "tests/physics_test_scene.json"},
+    {"billiard", "assets/scene/billiard.json"},
+};
+
+constexpr uint32_t kTileSize = 16;
+constexpr double kMaxPSNR = 99.0;  // Для совпадающих изображений
+
+struct Options {
+  bool update = false;
+  int width = 400;
+  int height = 300;
+  int frames = 3;
+  double minPSNR = 40.0;
+  double minTilePSNR = 28.0;
+  std::string timings = "golden_timings.csv";
+  std::string scene;  // Пусто - все сцены
+};
+
+struct DiffResult {
+  double psnr = kMaxPSNR;
+  double worstTilePSNR = kMaxPSNR;
+  uint32_t worstTileX = 0;
+  uint32_t worstTileY = 0;
+};
+
+double ToPSNR(double mse) {
+  if (mse <= 0.0) {
+    return kMaxPSNR;
+  }
+  return std::min(kMaxPSNR, 10.0 * std::log10(255.0 * 255.0 / mse));
+}
+
+// Ошибка пикселя взвешивается как яркость (Rec. 601): глаз заметнее
+// реагирует на зелёный, чем на синий. Тайлы считаются параллельно, и
+// худший тайл ловит локальные артефакты, которые теряются в общем PSNR
+DiffResult CompareImages(const RawImage& actual, const RawImage& expected) {
+  const uint32_t width = actual.GetWidth();
+  const uint32_t height = actual.GetHeight();
+  const uint32_t tilesX = (width + kTileSize - 1) / kTileSize;
+  const uint32_t tilesY = (height + kTileSize - 1) / kTileSize;
+  std::vector<double> tileError(size_t(tilesX) * tilesY, 0.0);
+
+  JobSystem::GetInstance().ParallelFor(
+      tilesY, 1, [&](size_t begin, size_t end, size_t) {
+        for (size_t ty = begin; ty < end; ++ty) {
+          uint32_t y0 = static_cast<uint32_t>(ty) * kTileSize;
+          uint32_t y1 = std::min(y0 + kTileSize, height);
+          for (uint32_t y = y0; y < y1; ++y) {
+            auto a = actual.GetRow(y);
+            auto b = expected.GetRow(y);
+            for (uint32_t x = 0; x < width; ++x) {
+              double db = double(a[3 * x + 0]) - b[3 * x + 0];
+              double dg = double(a[3 * x + 1]) - b[3 * x + 1];
+              double dr = double(a[3 * x + 2]) - b[3 * x + 2];
+              tileError[ty * tilesX + x / kTileSize] +=
+                  0.299 * dr * dr + 0.587 * dg * dg + 0.114 * db * db;
+            }
+          }
+        }
+      });
+
+  DiffResult result;
+  double total = 0.0;
+  for (uint32_t ty = 0; ty < tilesY; ++ty) {
+    for (uint32_t tx = 0; tx < tilesX; ++tx) {
+      double error = tileError[ty * tilesX + tx];
+      total += error;
+      uint32_t w = std::min(kTileSize, width - tx * kTileSize);
+      uint32_t h = std::min(kTileSize, height - ty * kTileSize);
+      double psnr = ToPSNR(error / (double(w) * h));
+      if (psnr < result.worstTilePSNR) {
+        result.worstTilePSNR = psnr;
+        result.worstTileX = tx;
+        result.worstTileY = ty;
+      }
+    }
+  }
+  result.psnr = ToPSNR(total / (double(width) * height));
+  return result;
+}
+
+// Разница, усиленная в 8 раз, - чтобы было видно, где разошлось
+RawImage MakeDiffImage(const RawImage& actual, const RawImage& expected) {
+  RawImage diff(actual.GetWidth(), actual.GetHeight());
+  for (uint32_t y = 0; y < actual.GetHeight(); ++y) {
+    auto a = actual.GetRow(y);
+    auto b = expected.GetRow(y);
+    auto d = diff.GetRow(y);
+    for (size_t i = 0; i < d.size(); ++i) {
+      d[i] = static_cast<uint8_t>(std::min(std::abs(a[i] - b[i]) * 8, 255));
+    }
+  }
+  return diff;
+}
+
+void AppendTiming(const Options& options,
+                  const std::string& scene,
+                  double medianMs,
+                  double minMs,
+                  const DiffResult& diff,
+                  const char* status) {
+  bool exists = std::filesystem::exists(options.timings);
+  std::ofstream csv(options.timings, std::ios::app);
+  if (!csv) {
+    std::cerr << "Cannot open " << options.timings << std::endl;
+    return;
+  }
+  if (!exists) {
+    csv << "timestamp,scene,width,height,frames,median_ms,min_ms,psnr_db,"
+           "worst_tile_psnr_db,threads,status\n";
+  }
+  std::time_t now = std::time(nullptr);
+  csv << std::put_time(std::gmtime(&now), "%Y-%m-%dT%H:%M:%SZ") << ','
+      << scene << ',' << options.width << ',' << options.height << ','
+      << options.frames << ',' << std::fixed << std::setprecision(3)
+      << medianMs << ',' << minMs << ',' << std::setprecision(2)
+      << diff.psnr << ',' << diff.worstTilePSNR << ','
+      << JobSystem::GetInstance().GetThreadCount() << ',' << status << '\n';
+}
+
+bool RunScene(const GoldenScene& golden, const Options& options) {
+  const std::filesystem::path root(ENGINE_SOURCE_DIR);
+  const std::filesystem::path reference =
+      root / "tests" / "golden" / (std::string(golden.name) + ".bmp");
+
+  SceneLoader loader = SceneLoader::Load((root / golden.path).string());
+  if (!loader.GetCamera()) {
+    std::cerr << golden.name << ": scene has no camera" << std::endl;
+    return false;
+  }
+  // Разрешение меняется при том же угле обзора, кадрирование сохраняется
+  Camera camera = *loader.GetCamera();
+  camera.SetResolution(options.width, options.height);
+
+  Renderer renderer;
+  RawImage image(options.width, options.height);
+  std::vector<double> times;
+  for (int frame = 0; frame < options.frames; ++frame) {
+    auto start = std::chrono::steady_clock::now();
+    renderer.Render(camera, loader.GetScene(), image);
+    auto finish = std::chrono::steady_clock::now();
+    times.push_back(
+        std::chrono::duration<double, std::milli>(finish - start).count());
+  }
+  std::sort(times.begin(), times.end());
+  const double medianMs = times[times.size() / 2];
+
+  if (options.update) {
+    std::filesystem::create_directories(reference.parent_path());
+    bool written = WriteImage(image, reference);
+    std::cout << golden.name << ": reference "
+              << (written ? "updated" : "NOT written") << " (" << medianMs
+              << " ms/frame)" << std::endl;
+    AppendTiming(options, golden.name, medianMs, times.front(), DiffResult{},
+                 written ? "updated" : "error");
+    return written;
+  }
+
+  RawImage expected = loadFromBMP(reference.string());
+  if (expected.GetWidth() != image.GetWidth() ||
+      expected.GetHeight() != image.GetHeight()) {
+    std::cerr << golden.name << ": no " << options.width << "x"
+              << options.height << " reference at " << reference
+              << " (create it with --update)" << std::endl;
+    AppendTiming(options, golden.name, medianMs, times.front(), DiffResult{},
+                 "missing");
+    return false;
+  }
+
+  DiffResult diff = CompareImages(image, expected);
+  bool passed =
+      diff.psnr >= options.minPSNR && diff.worstTilePSNR >= options.minTilePSNR;
+  std::cout << golden.name << ": " << (passed ? "OK" : "FAIL") << "  PSNR "
+            << std::fixed << std::setprecision(2) << diff.psnr
+            << " dB, worst tile " << diff.worstTilePSNR << " dB (x "
+            << diff.worstTileX * kTileSize << ", y "
+            << diff.worstTileY * kTileSize << " from the bottom), "
+            << std::setprecision(1) << medianMs << " ms/frame" << std::endl;
+  AppendTiming(options, golden.name, medianMs, times.front(), diff,
+               passed ? "pass" : "fail");
+
+  if (!passed) {
+    // Результат и разница - рядом с запуском, для разбора
+    WriteImage(image, std::string(golden.name) + "_actual.bmp");
+    WriteImage(MakeDiffImage(image, expected),
+               std::string(golden.name) + "_diff.bmp");
+  }
+  return passed;
+}
+
+bool ParseOptions(int argc, char** argv, Options& options) {
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--update") {
+      options.update = true;
+    } else if (arg == "--size" && hasValue) {
+      if (std::sscanf(argv[++i], "%dx%d", &options.width, &options.height) !=
+              2 ||
+          options.width <= 0 || options.height <= 0) {
+        std::cerr << "Invalid size: " << argv[i] << std::endl;
+        return false;
+      }
+    } else if (arg == "--frames" && hasValue) {
+      options.frames = std::max(1, std::atoi(argv[++i]));
+    } else if (arg == "--min-psnr" && hasValue) {
+      options.minPSNR = std::atof(argv[++i]);
+    } else if (arg == "--min-tile-psnr" && hasValue) {
+      options.minTilePSNR = std::atof(argv[++i]);
+    } else if (arg == "--timings" && hasValue) {
+      options.timings = argv[++i];
+    } else if (arg == "--scene" && hasValue) {
+      options.scene = argv[++i];
+    } else {
+      std::cerr << "Unknown argument: " << arg << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options;
+  if (!ParseOptions(argc, argv, options)) {
+    return 2;
+  }
+
+  int failed = 0;
+  int ran = 0;
+  for (const GoldenScene& golden : kScenes) {
+    if (!options.scene.empty() && options.scene != golden.name) {
+      continue;
+    }
+    ++ran;
+    try {
+      if (!RunScene(golden, options)) {
+        ++failed;
+      }
+    } catch (const std::exception& e) {
+      std::cerr << golden.name << ": " << e.what() << std::endl;
+      ++failed;
+    }
+  }
+  if (ran == 0) {
+    std::cerr << "Scene not found: " << options.scene << std::endl;
+    return 2;
+  }
+  return failed == 0 ? 0 : 1;
+}
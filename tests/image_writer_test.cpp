@@ -0,0 +1,359 @@
+// Проверка потоковых писателей изображений.
+//
+// Рендерит небольшой кадр через Renderer::RenderToStream в каждый формат
+// (BMP, PPM, PNG, EXR), читает файлы обратно и сравнивает с тем же
+// кадром, отрендеренным в память через Renderer::Render. Для PNG
+// дополнительно проверяются CRC чанков и Adler-32 потока zlib, для EXR -
+// таблица смещений строк.
+//
+//   image_writer_test [--keep]
+//
+// --keep оставляет записанные файлы во временном каталоге.
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "render/image_writer.h"
+#include "render/pixel_kernels.h"
+#include "render/raw_image.h"
+#include "render/renderer.h"
+#include "render/scene_loader.h"
+
+#ifndef ENGINE_SOURCE_DIR
+#define ENGINE_SOURCE_DIR "."
+#endif
+
+namespace {
+
+constexpr uint32_t kWidth = 37;  // Нечётная ширина: у BMP есть выравнивание
+constexpr uint32_t kHeight = 23;
+constexpr uint32_t kBandHeight = 5;  // Последняя полоса неполная
+
+std::vector<uint8_t> ReadFile(const std::filesystem::path& path) {
+  std::ifstream in(path, std::ios_base::binary);
+  return std::vector<uint8_t>(std::istreambuf_iterator<char>(in),
+                              std::istreambuf_iterator<char>());
+}
+
+uint32_t GetU32BE(const uint8_t* data) {
+  return (uint32_t(data[0]) << 24) | (uint32_t(data[1]) << 16) |
+         (uint32_t(data[2]) << 8) | data[3];
+}
+
+uint32_t GetU32LE(const uint8_t* data) {
+  return data[0] | (uint32_t(data[1]) << 8) | (uint32_t(data[2]) << 16) |
+         (uint32_t(data[3]) << 24);
+}
+
+uint64_t GetU64LE(const uint8_t* data) {
+  return GetU32LE(data) | (uint64_t(GetU32LE(data + 4)) << 32);
+}
+
+// Строка y (0 - нижняя, как в RawImage) в RGB
+bool RowMatchesRGB(const RawImage& expected, uint32_t y, const uint8_t* rgb) {
+  auto row = expected.GetRow(y);
+  for (uint32_t x = 0; x < kWidth; ++x) {
+    if (rgb[3 * x + 0] != row[3 * x + 2] || rgb[3 * x + 1] != row[3 * x + 1] ||
+        rgb[3 * x + 2] != row[3 * x + 0]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool CheckBMP(const std::filesystem::path& path, const RawImage& expected) {
+  RawImage image = loadFromBMP(path.string());
+  if (image.GetWidth() != kWidth || image.GetHeight() != kHeight) {
+    std::cerr << "BMP: wrong size " << image.GetWidth() << "x"
+              << image.GetHeight() << std::endl;
+    return false;
+  }
+  for (uint32_t y = 0; y < kHeight; ++y) {
+    auto a = image.GetRow(y);
+    auto b = expected.GetRow(y);
+    if (!std::equal(a.begin(), a.begin() + kWidth * 3, b.begin())) {
+      std::cerr << "BMP: row " << y << " differs" << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool CheckPPM(const std::filesystem::path& path, const RawImage& expected) {
+  std::vector<uint8_t> file = ReadFile(path);
+  const std::string header =
+      "P6\n" + std::to_string(kWidth) + ' ' + std::to_string(kHeight) +
+      "\n255\n";
+  if (file.size() != header.size() + size_t(kWidth) * kHeight * 3 ||
+      std::memcmp(file.data(), header.data(), header.size()) != 0) {
+    std::cerr << "PPM: unexpected header or file size" << std::endl;
+    return false;
+  }
+  // Строки PPM идут сверху вниз
+  const uint8_t* pixels = file.data() + header.size();
+  for (uint32_t row = 0; row < kHeight; ++row) {
+    if (!RowMatchesRGB(expected, kHeight - 1 - row,
+                       pixels + size_t(row) * kWidth * 3)) {
+      std::cerr << "PPM: row " << row << " differs" << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+uint32_t CRC32(const uint8_t* data, size_t size) {
+  uint32_t crc = 0xFFFFFFFFu;
+  for (size_t i = 0; i < size; ++i) {
+    crc ^= data[i];
+    for (int k = 0; k < 8; ++k) {
+      crc = (crc & 1) ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+    }
+  }
+  return crc ^ 0xFFFFFFFFu;
+}
+
+uint32_t Adler32(const std::vector<uint8_t>& data) {
+  uint32_t a = 1;
+  uint32_t b = 0;
+  for (uint8_t byte : data) {
+    a = (a + byte) % 65521;
+    b = (b + a) % 65521;
+  }
+  return (b << 16) | a;
+}
+
+bool CheckPNG(const std::filesystem::path& path, const RawImage& expected) {
+  static const uint8_t signature[8] = {0x89, 'P', 'N', 'G',
+                                       '\r', '\n', 0x1A, '\n'};
+  std::vector<uint8_t> file = ReadFile(path);
+  if (file.size() < 8 || std::memcmp(file.data(), signature, 8) != 0) {
+    std::cerr << "PNG: bad signature" << std::endl;
+    return false;
+  }
+
+  // Чанки: длина, тип, данные, CRC по типу и данным
+  std::vector<uint8_t> zlib;
+  bool sawHeader = false;
+  bool sawEnd = false;
+  size_t offset = 8;
+  while (offset + 12 <= file.size() && !sawEnd) {
+    const uint32_t length = GetU32BE(&file[offset]);
+    if (offset + 12 + length > file.size()) {
+      break;
+    }
+    const std::string type(reinterpret_cast<const char*>(&file[offset + 4]),
+                           4);
+    const uint8_t* data = &file[offset + 8];
+    if (CRC32(&file[offset + 4], 4 + length) != GetU32BE(data + length)) {
+      std::cerr << "PNG: CRC mismatch in " << type << std::endl;
+      return false;
+    }
+    if (type == "IHDR") {
+      sawHeader = length == 13 && GetU32BE(data) == kWidth &&
+                  GetU32BE(data + 4) == kHeight && data[8] == 8 &&
+                  data[9] == 2;
+    } else if (type == "IDAT") {
+      zlib.insert(zlib.end(), data, data + length);
+    } else if (type == "IEND") {
+      sawEnd = true;
+    }
+    offset += 12 + length;
+  }
+  if (!sawHeader || !sawEnd || offset != file.size()) {
+    std::cerr << "PNG: missing or malformed IHDR/IEND" << std::endl;
+    return false;
+  }
+
+  // Поток zlib из несжатых блоков deflate и Adler-32 распакованных данных
+  if (zlib.size() < 6 || (zlib[0] * 256 + zlib[1]) % 31 != 0 ||
+      (zlib[0] & 0x0F) != 8) {
+    std::cerr << "PNG: bad zlib header" << std::endl;
+    return false;
+  }
+  std::vector<uint8_t> raw;
+  size_t pos = 2;
+  bool final = false;
+  while (!final) {
+    if (pos + 5 > zlib.size() || (zlib[pos] & 0x06) != 0) {
+      std::cerr << "PNG: expected a stored deflate block" << std::endl;
+      return false;
+    }
+    final = zlib[pos] & 1;
+    const uint32_t length = zlib[pos + 1] | (zlib[pos + 2] << 8);
+    const uint32_t inverse = zlib[pos + 3] | (zlib[pos + 4] << 8);
+    if ((length ^ 0xFFFF) != inverse || pos + 5 + length > zlib.size()) {
+      std::cerr << "PNG: bad stored block length" << std::endl;
+      return false;
+    }
+    raw.insert(raw.end(), zlib.begin() + pos + 5,
+               zlib.begin() + pos + 5 + length);
+    pos += 5 + length;
+  }
+  if (pos + 4 != zlib.size() || GetU32BE(&zlib[pos]) != Adler32(raw)) {
+    std::cerr << "PNG: Adler-32 mismatch" << std::endl;
+    return false;
+  }
+
+  // Строки сверху вниз: байт фильтра (0) и RGB
+  const size_t stride = 1 + size_t(kWidth) * 3;
+  if (raw.size() != stride * kHeight) {
+    std::cerr << "PNG: unexpected image data size" << std::endl;
+    return false;
+  }
+  for (uint32_t row = 0; row < kHeight; ++row) {
+    const uint8_t* line = raw.data() + row * stride;
+    if (line[0] != 0 || !RowMatchesRGB(expected, kHeight - 1 - row, line + 1)) {
+      std::cerr << "PNG: row " << row << " differs" << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool CheckEXR(const std::filesystem::path& path, const RawImage& expected) {
+  std::vector<uint8_t> file = ReadFile(path);
+  if (file.size() < 8 || GetU32LE(file.data()) != 20000630 ||
+      (GetU32LE(file.data() + 4) & 0xFF) != 2) {
+    std::cerr << "EXR: bad magic or version" << std::endl;
+    return false;
+  }
+
+  // Атрибуты заголовка: имя, тип, размер, значение; пустое имя - конец
+  size_t offset = 8;
+  auto readString = [&](std::string& out) {
+    size_t end = offset;
+    while (end < file.size() && file[end] != 0) {
+      ++end;
+    }
+    if (end >= file.size()) {
+      return false;
+    }
+    out.assign(reinterpret_cast<const char*>(&file[offset]), end - offset);
+    offset = end + 1;
+    return true;
+  };
+  for (;;) {
+    std::string name;
+    std::string type;
+    if (!readString(name)) {
+      std::cerr << "EXR: truncated header" << std::endl;
+      return false;
+    }
+    if (name.empty()) {
+      break;
+    }
+    if (!readString(type) || offset + 4 > file.size()) {
+      std::cerr << "EXR: truncated attribute " << name << std::endl;
+      return false;
+    }
+    offset += 4 + GetU32LE(&file[offset]);
+  }
+
+  // Таблица смещений: каждая строка начинается своим номером и размером
+  // и заканчивается там, где начинается следующая
+  const uint32_t dataSize = kWidth * 3 * sizeof(float);
+  const size_t table = offset;
+  if (table + 8ull * kHeight > file.size()) {
+    std::cerr << "EXR: truncated offset table" << std::endl;
+    return false;
+  }
+  uint64_t next = table + 8ull * kHeight;
+  std::vector<vec3> colors(kWidth);
+  std::vector<uint8_t> bgr(kWidth * 3);
+  for (uint32_t row = 0; row < kHeight; ++row) {
+    const uint64_t start = GetU64LE(&file[table + 8ull * row]);
+    if (start != next || start + 8 + dataSize > file.size() ||
+        GetU32LE(&file[start]) != row ||
+        GetU32LE(&file[start + 4]) != dataSize) {
+      std::cerr << "EXR: bad offset table entry for row " << row << std::endl;
+      return false;
+    }
+    next = start + 8 + dataSize;
+
+    // Каналы B, G, R подряд; линейный цвет даёт тот же BGR8 после
+    // тонмаппинга и sRGB-кодирования
+    const uint8_t* channels = &file[start + 8];
+    for (int channel = 0; channel < 3; ++channel) {
+      for (uint32_t x = 0; x < kWidth; ++x) {
+        float value = 0.0f;
+        std::memcpy(&value, channels + (channel * kWidth + x) * 4, 4);
+        colors[x][2 - channel] = value;
+      }
+    }
+    ReinhardTonemapRow(colors.data(), kWidth);
+    EncodeSRGBRow(colors.data(), bgr.data(), kWidth);
+    auto line = expected.GetRow(kHeight - 1 - row);
+    if (!std::equal(bgr.begin(), bgr.end(), line.begin())) {
+      std::cerr << "EXR: row " << row << " differs" << std::endl;
+      return false;
+    }
+  }
+  if (next != file.size()) {
+    std::cerr << "EXR: trailing data after the last row" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+struct Format {
+  const char* extension;
+  bool (*check)(const std::filesystem::path&, const RawImage&);
+};
+
+const Format kFormats[] = {
+    {".bmp", CheckBMP},
+    {".ppm", CheckPPM},
+    {".png", CheckPNG},
+    {".exr", CheckEXR},
+};
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  bool keep = argc > 1 && std::string(argv[1]) == "--keep";
+
+  const std::filesystem::path root(ENGINE_SOURCE_DIR);
+  SceneLoader loader =
+      SceneLoader::Load((root / "tests" / "physics_test_scene.json").string());
+  if (!loader.GetCamera()) {
+    std::cerr << "Test scene has no camera" << std::endl;
+    return 2;
+  }
+  Camera camera = *loader.GetCamera();
+  camera.SetResolution(kWidth, kHeight);
+
+  // Эталон - тот же кадр, отрендеренный целиком в память
+  Renderer renderer;
+  RawImage expected(kWidth, kHeight);
+  renderer.Render(camera, loader.GetScene(), expected);
+
+  const std::filesystem::path dir =
+      std::filesystem::temp_directory_path() / "image_writer_test";
+  std::filesystem::create_directories(dir);
+
+  int failed = 0;
+  for (const Format& format : kFormats) {
+    const std::filesystem::path path =
+        dir / (std::string("frame") + format.extension);
+    auto writer = ImageWriter::Open(path, kWidth, kHeight);
+    bool passed =
+        writer &&
+        renderer.RenderToStream(camera, loader.GetScene(), *writer,
+                                kBandHeight) &&
+        format.check(path, expected);
+    std::cout << format.extension + 1 << ": " << (passed ? "OK" : "FAIL")
+              << std::endl;
+    failed += passed ? 0 : 1;
+  }
+
+  if (!keep) {
+    std::filesystem::remove_all(dir);
+  }
+  return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,111 @@
+// Собирает текстуры материалов из манифеста в один пакет с готовыми
+// мип-уровнями (см. render/texture_pack.h).
+//
+// Использование: texture_packer [--format bgr8|bc1|bc3|bc7] [манифест]
+//                               [выходной файл]
+// По умолчанию BC7, assets/textures/textures_manifest.json ->
+// assets/textures/textures.pack
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <nlohmann/json.hpp>
+#include "render/raw_image.h"
+#include "render/texture_pack.h"
+
+using json = nlohmann::json;
+
+// Формат по имени из командной строки
+static bool ParseFormat(const std::string& name, TexturePackFormat& format) {
+  static const std::pair<const char*, TexturePackFormat> kFormats[] = {
+      {"bgr8", TexturePackFormat::BGR8},
+      {"bc1", TexturePackFormat::BC1},
+      {"bc3", TexturePackFormat::BC3},
+      {"bc7", TexturePackFormat::BC7},
+  };
+  for (const auto& [formatName, value] : kFormats) {
+    if (name == formatName) {
+      format = value;
+      return true;
+    }
+  }
+  return false;
+}
+
+int main(int argc, char* argv[]) {
+  TexturePackFormat format = TexturePackFormat::BC7;
+  std::vector<std::string> paths;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--format" && i + 1 < argc) {
+      if (!ParseFormat(argv[++i], format)) {
+        std::cerr << "Unknown format: " << argv[i] << std::endl;
+        return 1;
+      }
+    } else {
+      paths.push_back(arg);
+    }
+  }
+  std::filesystem::path manifestPath = "assets/textures/textures_manifest.json";
+  std::filesystem::path outputPath = "assets/textures/textures.pack";
+  if (paths.size() > 0) {
+    manifestPath = paths[0];
+  }
+  if (paths.size() > 1) {
+    outputPath = paths[1];
+  }
+
+  std::ifstream manifestFile(manifestPath);
+  if (!manifestFile) {
+    std::cerr << "Cannot open manifest: " << manifestPath << std::endl;
+    return 1;
+  }
+  json manifest;
+  try {
+    manifestFile >> manifest;
+  } catch (const json::exception& e) {
+    std::cerr << "Invalid manifest: " << e.what() << std::endl;
+    return 1;
+  }
+  std::filesystem::path texturesDir = manifestPath.parent_path();
+
+  std::vector<PackedTexture> textures;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  for (const auto& [name, value] : manifest.items()) {
+    if (!value.is_string()) {
+      continue;
+    }
+    std::string file = value.get<std::string>();
+    RawImage image = loadFromBMP((texturesDir / file).string());
+    if (image.GetWidth() == 0) {
+      return 1;  // Причину уже вывел loadFromBMP
+    }
+
+    // Размер пакета задаёт первая текстура, остальные масштабируются
+    if (width == 0) {
+      width = image.GetWidth();
+      height = image.GetHeight();
+    } else if (image.GetWidth() != width || image.GetHeight() != height) {
+      std::cerr << "Resampling " << file << " to " << width << "x" << height
+                << std::endl;
+      image = resampleImage(image, width, height);
+    }
+
+    // Мип-цепочка; блоки кодируются во всех потоках пула
+    textures.push_back({name, file, BuildMipChain(image, format)});
+  }
+
+  if (textures.empty()) {
+    std::cerr << "Manifest has no textures: " << manifestPath << std::endl;
+    return 1;
+  }
+  if (!WriteTexturePack(outputPath.string(), format, width, height,
+                        textures)) {
+    std::cerr << "Failed to write " << outputPath << std::endl;
+    return 1;
+  }
+  std::cerr << "Packed " << textures.size() << " textures (" << width << "x"
+            << height << ") into " << outputPath << std::endl;
+  return 0;
+}